@@ -1,4 +1,30 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+//for SCHED_IDLE
+
 #include "jsonParser.h"
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <math.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef JSON_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JSON_ZSTD
+#include <zstd.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 //a copy of the bytes in a file
 typedef struct {
@@ -7,8 +33,269 @@ typedef struct {
 
 	//a copy of the bytes in the file
 	char* bytes;
+
+	//parseFlags for the nodes made from the file
+	int flags;
+
+	//what is left of the limits, only used with parse_LIMITS
+	struct parseBudget* budget;
 } filecopy;
 
+//options for how nodes are made from a filecopy
+enum parseFlags {
+
+	//containers are made as spannedNodes
+	parse_SPANS = 0x1,
+
+	//numbers outside of packed arrays are left as text until they are read
+	parse_LAZY = 0x2,
+
+	//the parse is checked against the filecopy's budget
+	parse_LIMITS = 0x4
+};
+
+//what a parse with parse_LIMITS has used so far
+typedef struct parseBudget {
+	//the limits being checked
+	json_limits limits;
+
+	//the number of containers the parse is inside of
+	int depth;
+
+	//the number of values made so far
+	long long nodes;
+
+	//the number of bytes the tree uses so far
+	long long memory;
+
+	//json_OK until a limit is passed, then the json_errorCode for it
+	int code;
+
+	//the offset the limit was passed at
+	long long offset;
+} parseBudget;
+
+//the formats a filecopy can be read from
+enum filecopyFormats {
+
+	//plain json
+	filecopy_PLAIN,
+
+	//gzip compressed json, needs JSON_ZLIB
+	filecopy_GZIP,
+
+	//zstd compressed json, needs JSON_ZSTD
+	filecopy_ZSTD
+};
+
+//the header at the start of a snapshot file, the root node follows directly after it
+typedef struct {
+	//should always be snapshotMagic
+	char magic[8];
+
+	//the version of the snapshot layout
+	int version;
+
+	//sizeof(void*) of the machine that wrote the snapshot
+	short ptrSize;
+
+	//set to 1 by the machine that wrote the snapshot, used to detect byte order
+	short byteOrder;
+
+	//the length of the whole snapshot in bytes, including the header
+	long long len;
+} snapshotHeader;
+
+//a tree that can have more than one owner, the root node is stored inside of it
+typedef struct {
+	//the number of owners the tree has
+	atomic_int refs;
+
+	//the source the tree's lazy numbers point into, or NULL
+	filecopy* source;
+
+	//the block the tree was compacted into, or NULL
+	void* block;
+
+	//the root of the tree
+	json root;
+} sharedDoc;
+
+//a distinct value found by json_dedup, every node with the same value maps to it
+typedef struct {
+	//the hash of the value, made from the hashes of its children
+	unsigned long long hash;
+
+	//the first node found with this value
+	json* node;
+
+	//where the value was copied to, or NULL if it hasn't been yet
+	json* copy;
+
+	//the index of the next entry in the same bucket, or -1
+	long long next;
+} dedupEntry;
+
+//the distinct values of a tree, and which one each node has
+typedef struct {
+	//the distinct values, there can't be more of them than there are nodes
+	dedupEntry* entries;
+	long long entryCount;
+
+	//the first entry of each bucket of values, or -1
+	long long* buckets;
+	long long bucketMask;
+
+	//an open addressed table from each node to the index of its entry
+	json** nodes;
+	long long* nodeEntries;
+	long long nodeMask;
+
+	//the number of bytes the distinct values take up in a block
+	long long size;
+} dedupTable;
+
+//a container node that knows where it came from in its source
+typedef struct {
+	//the node itself
+	json node;
+
+	//the offset of the opening bracket, relative to the start of the parent container
+	// NOTE: the root stores its offset from the start of the source
+	long long start;
+
+	//the number of bytes from the opening bracket to the closing bracket
+	long long len;
+} spannedNode;
+
+//a tree that keeps its source so that it can be reparsed after edits
+typedef struct {
+	//the source of the tree, made with parse_SPANS
+	filecopy* source;
+
+	//the root of the tree
+	spannedNode root;
+} editDoc;
+
+//a tree whose lazy numbers point into its source, made by json_parseLazy
+typedef struct {
+	//the source of the tree, made with parse_LAZY
+	filecopy* source;
+
+	//the root of the tree
+	json root;
+} sourceDoc;
+
+//holds the current version of a frozen tree
+struct json_slot {
+	//the current version, the slot owns one reference to it
+	_Atomic(json*) current;
+
+	//flips every swap, readers are counted under the epoch they started in
+	atomic_int epoch;
+
+	//the number of readers in the middle of json_slotAcquire for each epoch
+	atomic_int readers[2];
+
+	//only one swap can happen at a time
+	pthread_mutex_t writeLock;
+};
+
+//the shared state of a json_parseFiles call
+typedef struct {
+	char** paths;
+	int pathCount;
+	json** out;
+
+	//the index of the next path to be claimed by a worker
+	atomic_int next;
+
+	//the number of files that were read
+	atomic_int parsed;
+} batchJob;
+
+//a tree in the path cache
+typedef struct cacheEntry {
+	//the path the tree was parsed from
+	char* path;
+
+	//the stat info of the file when it was parsed
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+
+	//the cached tree, the cache owns one reference to it
+	json* root;
+
+	//the estimated number of bytes the tree uses
+	long long bytes;
+
+	//the next entry in the cache, entries are kept in most recently used order
+	struct cacheEntry* next;
+} cacheEntry;
+
+//an ordered list of keys in the shape table
+typedef struct shapeEntry {
+	//the id given to objects with these keys
+	int id;
+
+	//a hash of the keys, to skip most entries without comparing them
+	unsigned long long hash;
+
+	//the number of keys
+	long long keyCount;
+
+	//a copy of the keys
+	json_key* keys;
+
+	//the next entry in the same bucket
+	struct shapeEntry* next;
+} shapeEntry;
+
+//writes json text to a buffer, or to a sink in blocks
+struct json_writer {
+	//where full blocks go, NULL for a writer that keeps everything in bytes
+	json_writeFunc write;
+	void* context;
+
+	//the bytes that haven't been flushed, or everything written for a buffer writer
+	char* bytes;
+	long long len;
+	long long capacity;
+
+	//the open containers, '[' or '{'
+	int depth;
+	char stack[json_MAXDEPTH];
+
+	//set when the next value needs a separator before it
+	char needComma;
+
+	//set after a key, until its value is written
+	char afterKey;
+
+	//set once a write fails, after which every call fails
+	char failed;
+};
+
+//an array or object json_transcode is inside of
+typedef struct {
+	//for messagepack, where the space for its head was left in the output
+	long long pos;
+
+	//the cbor major type of the container, 4 for arrays and 5 for maps
+	int major;
+
+	//the number of elements, or members for maps
+	long long count;
+} transcodeFrame;
+
+//a tree waiting to be freed by the reclaimer thread
+typedef struct reclaimEntry {
+	json* root;
+	struct reclaimEntry* next;
+} reclaimEntry;
+
 enum json_typeFlags {
 	
 	//is a number
@@ -61,7 +348,70 @@ enum json_typeFlags {
 	json_EMPTYOBJECT = 0xc00,
 
 	//the json file is malformed, ie a value of 'treu' or 'fasle' would be marked as invalid
-	json_INVALID = 0x1000
+	json_INVALID = 0x1000,
+
+	//the node is part of a mapped snapshot, so its pointers are stored as offsets
+	// NOTE: this flag should not be assigned as a type on its own
+	json_MAPPED = 0x2000,
+
+	//the node is the root of a sharedDoc and is freed when its last owner removes it
+	// NOTE: this flag should not be assigned as a type on its own
+	json_SHARED = 0x4000,
+
+	//the node is a container allocated as a spannedNode
+	// NOTE: this flag should not be assigned as a type on its own
+	json_SPANNED = 0x8000,
+
+	//the node is the root of an editDoc
+	// NOTE: this flag should not be assigned as a type on its own
+	json_EDITABLE = 0x10000,
+
+	//the node is an array stored as a json_nodePacked of ints
+	// NOTE: this flag should not be assigned as a type on its own
+	json_PACKEDINT = 0x20000,
+
+	//the node is an array stored as a json_nodePacked of doubles
+	// NOTE: this flag should not be assigned as a type on its own
+	json_PACKEDDOUBLE = 0x40000,
+
+	//either of the packed flags
+	json_PACKED = 0x60000,
+
+	//the node is a number stored as a json_nodeLazy
+	// NOTE: this flag should not be assigned as a type on its own
+	json_LAZY = 0x80000,
+
+	//the node is a lazy number whose value has been converted
+	// NOTE: this flag should not be assigned as a type on its own
+	json_LAZYDONE = 0x100000,
+
+	//the node is the root of a sourceDoc
+	// NOTE: this flag should not be assigned as a type on its own
+	json_SOURCED = 0x200000,
+
+	//the node is a string kept in data.small
+	// NOTE: this flag should not be assigned as a type on its own
+	json_INLINE = 0x400000,
+
+	//the node is part of a block made by json_compact, the root is at the start of the block
+	// NOTE: this flag should not be assigned as a type on its own
+	json_COMPACT = 0x800000,
+
+	//the node is an element of an unpacked array that was one of its views, and is freed with the array
+	// NOTE: this flag should not be assigned as a type on its own
+	json_VIEW = 0x1000000,
+
+	//the node is an array whose elements include its old views, which are kept in data.packed.views
+	// NOTE: this flag should not be assigned as a type on its own
+	json_ADOPTED = 0x2000000,
+
+	//the node is inside a tree that has been shared, so it is read only like the tree's root
+	// NOTE: this flag should not be assigned as a type on its own
+	json_FROZEN = 0x4000000,
+
+	//the node is the root of a json_compact block with packed arrays in it, whose views are freed before the block
+	// NOTE: this flag should not be assigned as a type on its own
+	json_PACKEDBLOCK = 0x8000000
 };
 
 //cnsts that shouldn't be in the header file
@@ -71,30 +421,90 @@ const char falseString[5] = {'f', 'a', 'l', 's', 'e'};
 const char validWhitespace[4] = {0x20, 0x09, 0x0a, 0x0d};
 const char validHex[22] = 
 	{'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f','A','B','C','D','E','F'};
+const char digitPairs[201] = 
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+const double powersOf10[16] = 
+	{1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+const char snapshotMagic[8] = {'J', 'S', 'O', 'N', 'S', 'N', 'A', 'P'};
+const int snapshotVersion = 6;
+const int filecopyBlockSize = 1 << 16;
+const int shapeMaxKeys = 64;
+const int shapeMaxCount = 1 << 16;
+
+//the shape table, guarded by shapeLock
+#define shapeBuckets (1 << 14)
+pthread_rwlock_t shapeLock = PTHREAD_RWLOCK_INITIALIZER;
+shapeEntry* shapeTable[shapeBuckets];
+int shapeCount = 0;
+
+//the reclaimer thread's queue, guarded by reclaimLock
+pthread_mutex_t reclaimLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t reclaimReady = PTHREAD_COND_INITIALIZER;
+pthread_cond_t reclaimDone = PTHREAD_COND_INITIALIZER;
+pthread_once_t reclaimOnce = PTHREAD_ONCE_INIT;
+reclaimEntry* reclaimHead = NULL;
+long long reclaimPending = 0;
+char reclaimRunning = 0;
+
+//the path cache, guarded by cacheLock
+pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+cacheEntry* cacheHead = NULL;
+long long cacheBytes = 0;
+long long cacheLimit = 64LL * 1024 * 1024;
 
 //functions that shouldn't be in the header file
 
 //makes a node tree from a json file
-json* makeNodeTree(int type, filecopy* jsonFile, int start, int* len);
+json* makeNodeTree(int type, filecopy* jsonFile, long long start, long long* len);
 
 //frees data allocated to a tree of json nodes
 void json_removeNodeTree(json** rootNode);
 
 //detects the data type at a given location in a json file
-int detectJsonType(filecopy* filec, int offset);
+int detectJsonType(filecopy* filec, long long offset);
 
-//frees data in a json node tree
+//frees the data a node owns, but not the node itself
 void removeNode(json* node);
 
+//frees what one node owns, pushing its child nodes onto pending
+void removeNodeData(json* node, arraylist* pending);
+
+//pushes a container's children onto pending, or frees them if it can't grow
+void removeNodeChildren(json** children, long long count, arraylist* pending);
+
 //checks if char is valid json white space
 char isWhitespace(char ws);
 
 //gets a number value from a json file at a specific location and puts that value in a node
-int makeNumberFromJson(int type, filecopy* filec, int offset, json* outVar);
+//returns the length of the number minus one, the same as the other make functions
+long long makeNumberFromJson(int type, filecopy* filec, long long offset, json* outVar);
+
+//gets the number of bytes in the number at the start of text, looking at no more than max bytes
+long long numberLen(const char* text, long long max);
+
+//adds nodes and bytes to what a limited parse has used
+//returns 1 if the parse is still in its limits, and 0 once a limit is passed
+char budgetSpend(filecopy* filec, long long nodes, long long bytes, long long offset);
+
+//converts the text of a lazy number and caches the value in the node
+void lazyConvert(json* node);
+
+//converts every lazy number in a tree
+void lazyConvertTree(json* node);
+
+//parses a filecopy with parse_LAZY into a sourceDoc, which takes over the filecopy
+json* parseLazy(filecopy* jsonFile);
 
 //makes a string from a json file at a given offset and puts in outVar
+//strings short enough to fit in the node are kept in data.small, and json_INLINE is added to outVar's type
 //returns the length of the string
-int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar);
+long long makeStringFromJson(int type, filecopy* filec, long long offset, json* outVar);
+
+//gets the string of a string node as its own allocation, for nodes that are about to be freed
+//inline strings are copied out, anything else is handed over as it is
+char* stringTake(json* node);
 
 //checks if a char is valid hexadecimal (0-f)
 char isHex(char hex);
@@ -106,30 +516,139 @@ char getHex(char hex);
 char stringCompare(char* str1, char* str2);
 
 //makes an array list with a specified number of elements with a specified size.
-arraylist* arraylistMake(int typeSize, int arrLength);
+arraylist* arraylistMake(long long typeSize, long long arrLength);
 
 //frees an arraylist.
 void arraylistRemove(arraylist** arrList);
 
 //increases the length of the array by resizeAmount.
 //growing the array by a negaive value will shrink the array by that value.
-void arraylistGrow(arraylist* arrList, int resizeAmount);
+//returns 1 on success, and 0 if memory couldn't be allocated, in which case the array is unchanged
+char arraylistGrow(arraylist* arrList, long long resizeAmount);
 
 //sets the length of the array to length
-void arraylistSetLength(arraylist* arrList, int newLength);
+//returns 1 on success, and 0 if memory couldn't be allocated
+char arraylistSetLength(arraylist* arrList, long long newLength);
 
 //adds 1 to the length of the arraylist and sets the added index to value.
-void arraylistPush(arraylist* arrList, void* value);
+//returns 1 on success, and 0 if memory couldn't be allocated
+char arraylistPush(arraylist* arrList, void* value);
 
 //removes 1 from the length arraylist and sets output to the removed value
 void arraylistPop(arraylist* arrList, void* output);
 
 //gets a pointer to the value of a given index in the array list.
 // WARNING: the return value will become meaningless after a resize
-void* arraylistGet(arraylist* arrList, int index);
+void* arraylistGet(arraylist* arrList, long long index);
 
 //sets the value of an index of the arraylist to a given value from a pointer.
-void arraylistSet(arraylist* arrList, int index, void* value);
+void arraylistSet(arraylist* arrList, long long index, void* value);
+
+//adds 1 to the length of the arraylist, moving everything from index on back by 1,
+//and sets index to value.
+//returns 1 on success, and 0 if memory couldn't be allocated
+char arraylistInsert(arraylist* arrList, long long index, void* value);
+
+//removes index from the arraylist, moving everything after it forward by 1,
+//and sets output to the removed value.
+void arraylistRemoveAt(arraylist* arrList, long long index, void* output);
+
+//makes a node with a type and no data
+json* makeNode(int type);
+
+//finds the index of the member of an object with a key of len bytes
+//returns -1 if there is no such member or val isn't an object
+long long findMember(json* val, const char* memberName, size_t len);
+
+//gets which packed flag a number type would be stored under
+int packedTypeOf(int type);
+
+//checks if an int is exactly the same as a double
+char exactAsDouble(long long num);
+
+//makes a number fit into a packed arraylist, turning the ints already in it into doubles if a double is added
+//returns 1 if it fits, and 0 if an int wouldn't be exact as a double
+char packedPromote(arraylist* values, int* packedType, json* number, int numberType);
+
+//fills outVar with the value at index of a packed arraylist
+void makePackedView(json* outVar, arraylist* values, long long index, int packedType);
+
+//makes a node for each value in a packed arraylist and pushes it to nodes
+//returns 1 on success, and 0 if memory couldn't be allocated
+char appendUnpacked(arraylist* nodes, arraylist* values, int packedType);
+
+//gets the node for index of a packed array, making the views the first time
+json* packedView(json* val, long long index);
+
+//turns a packed array back into an array of nodes, so that it can be modified
+//views that were already handed out become the nodes, so pointers to them stay valid
+//returns 1 on success, and 0 if memory couldn't be allocated, in which case the array is still packed
+char unpackArray(json* val);
+
+//finds the end of the value at offset without making any nodes
+//returns the offset of the last byte of the value, or -1 if the file ends first
+// NOTE: only the brackets and quotes are checked, the rest of the value is not validated
+long long skipValue(filecopy* filec, long long offset);
+
+//makes a node tree like makeNodeTree, but only keeps the members on paths
+//each path is the rest of a projection path after the members already walked through
+json* makeProjectedTree(int type, filecopy* jsonfile, long long start, long long* len, char** paths, int pathCount);
+
+//sets up out with a column for each field and no rows
+//returns 1 on success, and 0 if memory couldn't be allocated
+char columnsMake(json_columns* out, char** fields, int fieldCount);
+
+//adds a row with no values to every column
+//returns 1 on success, and 0 if memory couldn't be allocated, in which case no row is added
+char columnsAddRow(json_columns* out);
+
+//gives a column a type and allocates its buffer
+//returns 1 on success, and 0 if memory couldn't be allocated, in which case the column has no type
+char columnSetType(json_columns* out, json_column* column, int type);
+
+//sets a column's value for the last row, converting ints to doubles if needed
+//values that don't match the column's type are left out
+//returns 1 on success, and 0 if memory couldn't be allocated
+char columnPut(json_columns* out, json_column* column, int type, long long num, double fraction, char* str, long long strLen);
+
+//takes the value of a column back out of the last row, for a key that shows up again in the same object
+void columnClear(json_columns* out, json_column* column);
+
+//reads one object of json text into the last row of out
+//returns the offset of the closing bracket, or -1 if the object is malformed or memory couldn't be allocated
+long long columnsReadObject(filecopy* jsonfile, long long offset, json_columns* out, char** fields);
+
+//makes a node with the json_INVALID type, after freeing partial
+json* makeInvalid(json* partial);
+
+//sets the code and offset of err if it isn't NULL
+//returns 0 so it can be returned directly
+char validateFail(json_error* err, int code, long long offset);
+
+//checks the string starting with the quote at offset
+//returns the offset after the closing quote, or -(offset of the error) - 1
+long long validateString(unsigned char* bytes, long long len, long long offset);
+
+//checks the number starting at offset
+//returns the offset after the number, or -(offset of the error) - 1
+long long validateNumber(unsigned char* bytes, long long len, long long offset);
+
+//parses the whole source of an editDoc into its root
+void editDocParse(editDoc* doc);
+
+//reparses the smallest container under the node in slot that holds an edit
+//returns 1 on success, and 0 if the edit changed where the container ends
+char reparseNode(json** slot, long long nodeStart, filecopy* src, long long editOffset, long long oldLen, long long delta);
+
+//reparses the child of node that holds an edit, and moves the spans after it by delta
+//returns 1 on success, 0 if no child holds the edit, and -1 if the edit broke the structure
+int reparseChildren(json* node, long long nodeStart, filecopy* src, long long editOffset, long long oldLen, long long delta);
+
+//checks if a node is a container that can be modified
+char canModify(json* val, int type);
+
+//sets or clears the json_EMPTY flag of a container to match its length
+void updateEmptyFlag(json* val);
 
 //makes a copy of a file from a path
 filecopy* filecopyMake(char* path);
@@ -137,10 +656,180 @@ filecopy* filecopyMake(char* path);
 //makes a filecopy from a FILE ptr
 filecopy* filecopyMakeFromFilePtr(FILE* filePtr);
 
+//makes a filecopy from a FILE ptr that can't be sized or rewound, like a pipe
+//the whole stream is read in large blocks into a buffer that grows geometrically
+filecopy* filecopyMakeFromStream(FILE* filePtr);
+
+//gets the filecopyFormat of a file from its first len bytes
+int filecopyFormatOf(const unsigned char* magic, long long len);
+
 //frees a file copy
 void filecopyRemove(filecopy** filec);
 
-int detectJsonType(filecopy* filec, int offset)
+//makes a null terminated filecopy from a buffer of bytes
+filecopy* filecopyMakeFromBytes(char* bytes, long long len);
+
+//makes a filecopy by decompressing a FILE ptr in blocks
+//format is one of the filecopyFormats
+filecopy* filecopyDecompress(FILE* filePtr, int format);
+
+//makes a filecopy by decompressing bytes that were already read
+filecopy* filecopyDecompressBytes(char* bytes, long long len, int format);
+
+//gets the address a pointer field points to
+//if mapped is set, the field holds an offset from its own address instead of a pointer
+void* resolvePtr(char mapped, void* const* field);
+
+//stores target in a pointer field as an offset from the field's own address
+void storeRelPtr(void** field, void* target);
+
+//stores target in a pointer field, as an offset if relative is set
+void storePtr(char relative, void** field, void* target);
+
+//gets the number of bytes a tree takes up when packed into a snapshot
+// NOTE: this is also used as an estimate of how much memory a tree uses
+long long treeSize(json* node, char relative);
+
+//gets the number of bytes a node takes up in a snapshot, not counting its children
+//if relative is set packed arrays are measured as arrays of nodes, like snapshotCopy writes them
+long long nodeSize(json* node, char relative);
+
+//copies a tree into a snapshot buffer at *used, and advances *used past it
+//if relative is set the copy is a snapshot, otherwise it is a json_compact block with plain pointers
+//if dedup is not NULL, each distinct value in it is only copied once and reused after that
+//returns the copied node
+json* snapshotCopy(json* node, char* buf, long long* used, char relative, dedupTable* dedup);
+
+//reserves len bytes in a snapshot buffer, keeping everything 8 byte aligned
+char* snapshotAlloc(char* buf, long long* used, long long len);
+
+//counts the nodes in a tree
+long long countNodes(json* node);
+
+//mixes a value into a hash
+unsigned long long dedupMix(unsigned long long hash, unsigned long long value);
+
+//finds the slot a node has, or would have, in the node table of a dedupTable
+long long dedupSlot(dedupTable* table, json* node);
+
+//gets the index of the entry a node was given by dedupVisit
+long long dedupFind(dedupTable* table, json* node);
+
+//checks if a node has the same value as an entry's node
+//children are compared by entry, so they have to have been visited already
+char dedupEqual(dedupTable* table, json* a, json* b);
+
+//gives every node in a tree the entry for its value, making new entries for values that weren't seen yet
+//returns the index of the node's entry
+long long dedupVisit(dedupTable* table, json* node);
+
+//moves a tree into one block, dedup is passed on to snapshotCopy
+//returns 1 on success and 0 on failure
+char compactTree(json** doc, long long len, dedupTable* dedup);
+
+//frees the views made for the packed arrays in a json_compact block, which aren't part of the block
+void compactViewsRemove(json* node);
+
+//moves a root node into a sharedDoc with one owner, along with the source its lazy numbers point into
+//returns the new root, or NULL if it couldn't be made
+// NOTE: the caller frees the old root if it was allocated on its own
+json* shareTree(json* root, filecopy* source);
+
+//marks every node under the root of a shared tree with json_FROZEN
+void shareMark(json* node);
+
+//adds an owner to a shared tree
+void shareRetain(json* root);
+
+//removes an owner from a shared tree, and frees the tree if it was the last one
+void shareRelease(json* root);
+
+//claims files from a batchJob and parses them until none are left
+//returns NULL, so that it can be used with pthread_create
+void* batchWorker(void* job);
+
+//reads a whole file into filec with pread, growing filec->bytes if it is smaller than capacity
+//returns 0 on success and -1 on failure
+int filecopyReadInto(filecopy* filec, long long* capacity, char* path);
+
+//gets the shape id of an ordered list of keys, adding it to the shape table if it is new
+//returns -1 if the object has too many keys, or the table is full
+int shapeOf(arraylist* keys);
+
+//hashes an ordered list of keys
+unsigned long long shapeHash(json_key* keys, long long keyCount);
+
+//makes a writer with an empty buffer of capacity bytes
+json_writer* writerMake(json_writeFunc write, void* context, long long capacity);
+
+//adds bytes to a writer, flushing whole blocks to its sink or growing its buffer
+//returns 1 on success, and 0 if the writer has failed
+char writerPut(json_writer* w, const char* bytes, long long len);
+
+//writes the separator that goes before a value, and checks that a value can go here
+//returns 1 on success, and 0 if the writer has failed
+char writerBeforeValue(json_writer* w);
+
+//writes a string with quotes, escaping what json needs escaped
+char writerQuoted(json_writer* w, const char* str, size_t len);
+
+//formats an integer into the end of buf, and returns where it starts
+char* writerFormatInt(char* bufEnd, long long num);
+
+//writes blocks to a FILE ptr, for json_writerMakeFile
+long long writerFileSink(void* context, const char* bytes, long long len);
+
+//writes blocks to a file descriptor, for json_writerMakeFd
+long long writerFdSink(void* context, const char* bytes, long long len);
+
+//encodes the head of a value into out, which needs room for 9 bytes
+//major is a cbor major type: 0 for n, 1 for -1 - n, 3 for a string n bytes long, 4 for an array and 5 for a map of n
+//returns the number of bytes written
+int transcodeHeader(int format, int major, unsigned long long n, unsigned char* out);
+
+//writes the head of a value to a writer
+void transcodePutHeader(json_writer* w, int format, int major, unsigned long long n);
+
+//decodes the escape whose letter is at raw[i] into utf8, which needs room for 4 bytes, and puts its length in utf8Len
+//returns the number of bytes of raw it used, or 0 if it is a surrogate without its other half
+int transcodeEscape(unsigned char* raw, long long rawLen, long long i, unsigned char* utf8, int* utf8Len);
+
+//writes the string at offset, decoding its escapes into utf-8
+//returns the offset after it, or -(offset of the error) - 1
+long long transcodeString(json_writer* w, int format, unsigned char* bytes, long long len, long long offset);
+
+//writes the number at offset as an int if it fits, and as a double if not
+//returns the offset after it, or -(offset of the error) - 1
+long long transcodeNumber(json_writer* w, int format, unsigned char* bytes, long long len, long long offset);
+
+//writes the head of a container, or leaves space for it in messagepack, and sets up its frame
+//returns 0 if the writer failed
+char transcodeOpen(json_writer* w, int format, transcodeFrame* frame, int major);
+
+//ends a container, filling in the head that was left for it in messagepack
+//returns 0 if it has too many elements for messagepack
+char transcodeClose(json_writer* w, int format, transcodeFrame* frame);
+
+//closes up the space in front of messagepack containers that their heads didn't need
+//returns the length of the output that is left
+long long transcodeSqueeze(unsigned char* out, long long len);
+
+//reads json text and writes its binary form into w
+//returns 1 on success, and 0 if the text is invalid or w failed, in which case err (if not NULL) says why and where
+char transcodeText(unsigned char* bytes, long long len, int format, json_writer* w, json_error* err);
+
+//frees the trees passed to json_removeAsync as they come in
+//returns NULL, so that it can be used with pthread_create
+void* reclaimWorker(void* unused);
+
+//starts the reclaimer thread, used with pthread_once
+void reclaimStart(void);
+
+//unlinks and releases cache entries until the cache is under its limit
+// NOTE: cacheLock must be held
+void cacheTrim(long long limit);
+
+int detectJsonType(filecopy* filec, long long offset)
 {
 
 	int numRetVal = json_NUMBER;//a return value for the number types
@@ -166,7 +855,7 @@ int detectJsonType(filecopy* filec, int offset)
 		case '9':
 			{
 				char temp;
-				while(!isWhitespace(temp = filec->bytes[offset]))
+				while(!isWhitespace(temp = filec->bytes[offset]) && (temp != '\0'))
 				{
 					offset++;
 					if((temp >= '0') && (temp <= '9'))continue;
@@ -236,7 +925,7 @@ int detectJsonType(filecopy* filec, int offset)
 			}
 			{
 				//checks for a valid ending character
-				char temp = filec->bytes[offset + 5];
+				char temp = filec->bytes[offset + 4];
 				if(
 					(temp != ']') && (temp != '}') && (temp != ',') &&
 					!isWhitespace(temp) && (temp != '\0')
@@ -253,7 +942,7 @@ int detectJsonType(filecopy* filec, int offset)
 			}
 			{
 				//checks for a valid ending character
-				char temp = filec->bytes[offset + 6];
+				char temp = filec->bytes[offset + 5];
 				if(
 					(temp != ']') && (temp != '}') && (temp != ',') &&
 					!isWhitespace(temp) && (temp != '\0')
@@ -267,7 +956,7 @@ int detectJsonType(filecopy* filec, int offset)
 			}
 			{
 				//checks for a valid ending character
-				char temp = filec->bytes[offset + 5];
+				char temp = filec->bytes[offset + 4];
 				if(
 					(temp != ']') && (temp != '}') && (temp != ',') &&
 					!isWhitespace(temp) && (temp != '\0')
@@ -290,7 +979,7 @@ json* json_parseFromPath(char* pathToFile)
 
 	if(jsonFile == NULL) return NULL;
 
-	int len = 0;
+	long long len = 0;
 
 	json* jsonNodeRoot = makeNodeTree(detectJsonType(jsonFile, 0), jsonFile, 0, &len);
 
@@ -306,7 +995,9 @@ json* json_parse(FILE* fptr)
 
 	filecopy* jsonFile = filecopyMakeFromFilePtr(fptr);
 
-	int len = 0;
+	if(jsonFile == NULL) return NULL;
+
+	long long len = 0;
 
 	json* jsonNodeRoot = makeNodeTree(detectJsonType(jsonFile, 0), jsonFile, 0, &len);
 
@@ -315,10 +1006,31 @@ json* json_parse(FILE* fptr)
 	return jsonNodeRoot;
 }
 
-json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
+json* makeNodeTree(int type, filecopy* jsonfile, long long start, long long* len)
 {
 
-	json* retVal = (json*) malloc(sizeof(json));
+	char spanned = ((jsonfile->flags & parse_SPANS) == parse_SPANS) &&
+		(((type & json_ARRAY) == json_ARRAY) || ((type & json_OBJECT) == json_OBJECT));
+
+	char limited = (jsonfile->flags & parse_LIMITS) == parse_LIMITS;
+	char container = ((type & json_ARRAY) == json_ARRAY) || ((type & json_OBJECT) == json_OBJECT);
+	if(limited)
+	{
+		parseBudget* budget = jsonfile->budget;
+		if(
+			!budgetSpend(jsonfile, 1, (spanned ? sizeof(spannedNode) : sizeof(json)) + sizeof(json*), start) ||
+			(container && (budget->limits.maxDepth > 0) && (budget->depth >= budget->limits.maxDepth))
+		)
+		{
+			if(budget->code == json_OK)budget->code = json_ERR_DEPTH, budget->offset = start;
+			*len = 0;
+			return makeNode(json_INVALID);
+		}
+		budget->depth += container;
+	}
+	//a limit being passed turns into an invalid node, which every parent already gives up on
+
+	json* retVal = (json*) malloc(spanned ? sizeof(spannedNode) : sizeof(json));
 	//allocs space
 
 	retVal->type = type;
@@ -327,11 +1039,27 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 	if((type & json_ARRAY) == json_ARRAY)
 	{
 		retVal->data.array = arraylistMake(sizeof(json*), 0);
-		int i = 0;
+		long long i = 0;
 		char canGetNextIndex = 1;
+
+		arraylist* packed = NULL;
+		int packedType = 0;
+		char canPack = 1;
+		//numbers are kept here without nodes while the array only has one kind of number
+
 		while(1)
 		{
 			i++;
+			if(start + i >= jsonfile->len)
+			{
+				if(packed != NULL)arraylistRemove(&packed);
+				json_removeNodeTree(&retVal);
+				retVal = (json*) malloc(sizeof(json));
+				retVal->type = json_INVALID;
+				*len = i;
+				return retVal;
+			}
+			//the container was never closed
 			if(jsonfile->bytes[start + i] == ']')break;
 			if(!isWhitespace(jsonfile->bytes[i + start]))
 			{
@@ -339,6 +1067,15 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 				{
 					if(canGetNextIndex)
 					{
+						if(packed != NULL)
+						{
+							appendUnpacked(retVal->data.array, packed, packedType);
+							arraylistRemove(&packed);
+							packed = NULL;
+						}
+						canPack = 0;
+						//a missing value becomes a null, so the array can't stay packed
+
 						json* nullVal = (json*) malloc(
 							sizeof(json)
 						);
@@ -351,8 +1088,60 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 					continue;
 				}
 
+				int childType = detectJsonType(jsonfile, i + start);
+
+				json number;
+				long long numberLen = 0;
+				char packable = canPack && canGetNextIndex && ((childType & json_NUMBER) == json_NUMBER);
+				if(packable)
+				{
+					numberLen = makeNumberFromJson(childType, jsonfile, i + start, &number);
+					packable = (packed == NULL) || packedPromote(packed, &packedType, &number, packedTypeOf(childType));
+				}
+				//ints and doubles can be packed together as doubles, like coordinates written as [102, 0.5]
+
+				if(packable)
+				{
+					if(packed == NULL)
+					{
+						packedType = packedTypeOf(childType);
+						packed = arraylistMake(sizeof(int64_t), 0);
+					}
+					//doubles and int64_ts are the same size, so ints can be turned into doubles in place
+
+					if(limited && !budgetSpend(jsonfile, 1, sizeof(double), i + start))
+					{
+						arraylistRemove(&packed);
+						json_removeNodeTree(&retVal);
+						*len = i;
+						return makeNode(json_INVALID);
+					}
+					//packed values count as values, even though they don't get nodes
+
+					*len = numberLen;
+					i += *len;
+
+					arraylistPush(
+						packed, 
+						(packedType == json_PACKEDDOUBLE) ? 
+							(void*) &(number.data.fraction) : (void*) &(number.data.number)
+					);
+					canGetNextIndex = 0;
+					continue;
+				}
+				//numbers are parsed straight into the packed values
+
+				if(packed != NULL)
+				{
+					appendUnpacked(retVal->data.array, packed, packedType);
+					arraylistRemove(&packed);
+					packed = NULL;
+				}
+				canPack = 0;
+				//anything else turns the array back into nodes
+
 				json* temp = makeNodeTree(
-					detectJsonType(jsonfile, i + start),
+					childType,
 					jsonfile,
 					i + start,
 					len
@@ -360,6 +1149,10 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 
 				i += *len;
 
+				if((temp->type & json_SPANNED) == json_SPANNED)
+					((spannedNode*) temp)->start -= start;
+				//spans are stored relative to the parent
+
 				if(
 					((temp->type | json_INVALID) == json_INVALID) 
 					|| !(canGetNextIndex)
@@ -378,21 +1171,48 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 			}
 		}
 		*len = i;
+
+		if(packed != NULL)
+		{
+			void* holder = realloc(packed->data, (size_t) packed->length * packed->size);
+			if(holder != NULL)
+			{
+				packed->data = holder;
+				packed->capacity = packed->length;
+			}
+			//packed arrays are never pushed to, so the spare capacity is given back
+
+			arraylistRemove(&(retVal->data.array));
+			retVal->data.packed.values = packed;
+			retVal->data.packed.views = NULL;
+			retVal->type |= packedType;
+		}
 	}
 	//if is an array, alloc array list
 
 	if((type & json_OBJECT) == json_OBJECT)
 	{
 		retVal->data.object.values = arraylistMake(sizeof(json*), 0);
-		retVal->data.object.keys = arraylistMake(sizeof(char*), 0);
+		retVal->data.object.keys = arraylistMake(sizeof(json_key), 0);
+		retVal->shape = 0;
+		//the shape is worked out by json_getMemberCached when it is first needed
 		
-		int i = 0;
+		long long i = 0;
 		char canGetNextKey = 1;
 		char canGetNextVal = 0;
 		
 		while(1)
 		{
 			i++;
+			if(start + i >= jsonfile->len)
+			{
+				json_removeNodeTree(&retVal);
+				retVal = (json*) malloc(sizeof(json));
+				retVal->type = json_INVALID;
+				*len = i;
+				return retVal;
+			}
+			//the container was never closed
 			if(jsonfile->bytes[start + i] == '}')break;
 			if(!isWhitespace(jsonfile->bytes[i + start]))
 			{
@@ -431,6 +1251,10 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 
 				i += *len;
 
+				if((temp->type & json_SPANNED) == json_SPANNED)
+					((spannedNode*) temp)->start -= start;
+				//spans are stored relative to the parent
+
 				if(
 					((temp->type | json_INVALID) == json_INVALID) &&
 					(canGetNextVal || canGetNextKey)
@@ -448,12 +1272,15 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 						arraylistPush(retVal->data.object.values, &temp);
 						canGetNextVal = 0;
 						continue;
-					} else if((temp->type | json_STRING) == json_STRING)
+					} else if((temp->type & ~(json_INLINE | json_EMPTY)) == json_STRING)
 					{
-						arraylistPush(
-							retVal->data.object.keys, 
-							&(temp->data.string)
-						);
+						if(limited)jsonfile->budget->nodes--;
+						//keys are counted by their string, but aren't values
+						size_t keyLen = 0;
+						json_getStringLen(temp, &keyLen);
+						json_key key = {stringTake(temp), keyLen};
+						//the length was found when the string was read, and keys can hold \u0000
+						arraylistPush(retVal->data.object.keys, &key);
 						free(temp);
 						canGetNextKey = 0;
 						continue;
@@ -468,10 +1295,25 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 			}
 		}
 		*len = i;
+
+		if(retVal->data.object.keys->length != retVal->data.object.values->length)
+		{
+			json_removeNodeTree(&retVal);
+			retVal = (json*) malloc(sizeof(json));
+			retVal->type = json_INVALID;
+			return retVal;
+		}
+		//a key was never given a value
 	}
 
-	if((type & json_NUMBER) == json_NUMBER)
+	if(((type & json_NUMBER) == json_NUMBER) && ((jsonfile->flags & parse_LAZY) == parse_LAZY))
+	{
+		retVal->type |= json_LAZY;
+		retVal->data.lazy.text = jsonfile->bytes + start;
+		*len = numberLen(jsonfile->bytes + start, jsonfile->len - start) - 1;
+	} else if((type & json_NUMBER) == json_NUMBER)
 		*len = makeNumberFromJson(type, jsonfile, start, retVal);
+	//lazy numbers are only measured, the text is converted the first time it is read
 
 	if((type & json_STRING) == json_STRING)
 	{
@@ -494,11 +1336,75 @@ json* makeNodeTree(int type, filecopy* jsonfile, int start, int* len)
 		*len = 3;
 	}
 
-	return retVal;
-}
+	if(spanned)
+	{
+		retVal->type |= json_SPANNED;
+		((spannedNode*) retVal)->start = start;
+		((spannedNode*) retVal)->len = *len + 1;
+	}
+	//containers that turned out invalid were already replaced by a plain node
+
+	if(limited)jsonfile->budget->depth -= container;
+	//invalid containers return early without this, but then the whole parse is given up on
+
+	return retVal;
+}
 
 void json_remove(json** jsonPtr)
 {
+	if((jsonPtr == NULL) || ((*jsonPtr) == NULL))return;
+
+	if(((*jsonPtr)->type & json_MAPPED) == json_MAPPED)
+	{
+		snapshotHeader* header = (snapshotHeader*) 
+			(((char*) *jsonPtr) - sizeof(snapshotHeader));
+
+		if(memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) == 0)
+			munmap(header, header->len);
+		*jsonPtr = NULL;
+		return;
+	}
+	//snapshots are unmapped rather than freed
+
+	if(((*jsonPtr)->type & json_SHARED) == json_SHARED)
+	{
+		shareRelease(*jsonPtr);
+		*jsonPtr = NULL;
+		return;
+	}
+	//shared trees are only freed by their last owner
+
+	if(((*jsonPtr)->type & json_EDITABLE) == json_EDITABLE)
+	{
+		editDoc* doc = (editDoc*) (((char*) *jsonPtr) - offsetof(editDoc, root));
+		removeNode(&(doc->root.node));
+		filecopyRemove(&(doc->source));
+		free(doc);
+		*jsonPtr = NULL;
+		return;
+	}
+	//editable trees also own their source
+
+	if(((*jsonPtr)->type & json_SOURCED) == json_SOURCED)
+	{
+		sourceDoc* doc = (sourceDoc*) (((char*) *jsonPtr) - offsetof(sourceDoc, root));
+		removeNode(&(doc->root));
+		filecopyRemove(&(doc->source));
+		free(doc);
+		*jsonPtr = NULL;
+		return;
+	}
+	//so do lazy trees
+
+	if(((*jsonPtr)->type & json_COMPACT) == json_COMPACT)
+	{
+		if(((*jsonPtr)->type & json_PACKEDBLOCK) == json_PACKEDBLOCK)compactViewsRemove(*jsonPtr);
+		free(*jsonPtr);
+		*jsonPtr = NULL;
+		return;
+	}
+	//the root of a compact tree is the start of its block
+
 	json_removeNodeTree(jsonPtr);
 }
 
@@ -507,46 +1413,89 @@ void json_removeNodeTree (json** rootNode)
 	if((rootNode == NULL) || ((*rootNode) == NULL))return;
 	//if the pointer is null, or points to null
 
-	if(((*rootNode)->type & json_ARRAY) == json_ARRAY)
+	removeNode(*rootNode);
+
+	if(((*rootNode)->type & json_VIEW) != json_VIEW)free(*rootNode);
+	*rootNode = NULL;
+	//adopted views are freed with the array they are in
+	return;
+}
+
+void removeNode(json* node)
+{
+	arraylist* pending = arraylistMake(sizeof(json*), 0);
+	//children still to be freed, so deep trees don't grow the call stack
+
+	removeNodeData(node, pending);
+	while((pending != NULL) && (pending->length > 0))
 	{
-		json* tempVal;
-		while((*rootNode)->data.array->length > 0)
-		{
-			arraylistPop((*rootNode)->data.array, &tempVal);
-			json_removeNodeTree(&tempVal);
-		}
-		arraylistRemove(&((*rootNode)->data.array));
+		json* child;
+		arraylistPop(pending, &child);
+		removeNodeData(child, pending);
+		free(child);
+	}
+	//a child's own children are pushed before the child is freed
+
+	if(pending != NULL)arraylistRemove(&pending);
+	return;
+}//frees the data a node owns, but not the node itself
+
+void removeNodeData(json* node, arraylist* pending)
+{
+	if((node->type & json_COMPACT) == json_COMPACT)return;
+	//compact nodes are freed with the block they are in
+
+	if((node->type & json_PACKED) != 0)
+	{
+		arraylistRemove(&(node->data.packed.values));
+		free(node->data.packed.views);
+		return;
 	}
-	//if the type is an array, free the values in the array
+	//packed arrays have no child nodes
 
-	if(((*rootNode)->type & json_OBJECT) == json_OBJECT)
+	if((node->type & json_ARRAY) == json_ARRAY)
 	{
-		json* tempNodeVal;
-		char* tempStrVal;
-		
-		while((*rootNode)->data.object.values->length > 0)
-		{
-			arraylistPop((*rootNode)->data.object.values, &tempNodeVal);
-			json_removeNodeTree(&tempNodeVal);
-		}
-		arraylistRemove(&((*rootNode)->data.object.values));
+		removeNodeChildren((json**) node->data.array->data, node->data.array->length, pending);
+		arraylistRemove(&(node->data.array));
+		if((node->type & json_ADOPTED) == json_ADOPTED)free(node->data.packed.views);
+	}
+	//if the type is an array, hand the values in the array to the stack
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		removeNodeChildren((json**) node->data.object.values->data, node->data.object.values->length, pending);
+		arraylistRemove(&(node->data.object.values));
 		
-		while((*rootNode)->data.object.keys->length > 0)
-		{
-			arraylistPop((*rootNode)->data.object.keys, &tempStrVal);
-			free(tempStrVal);
-		}
-		arraylistRemove(&((*rootNode)->data.object.keys));
+		json_key* keys = (json_key*) node->data.object.keys->data;
+		for(long long i = 0; i < node->data.object.keys->length; i++)
+			free(keys[i].string);
+		arraylistRemove(&(node->data.object.keys));
 
 	}
-	//if the type is an object, free the key/value pairs in the object
+	//if the type is an object, free the keys and hand the values to the stack
 	
-	if(((*rootNode)->type & json_STRING) == json_STRING)free((*rootNode)->data.string);
+	if((node->type & (json_STRING | json_INLINE)) == json_STRING)free(node->data.string);
+	return;
+}//frees what one node owns and pushes its child nodes onto pending
 
-	free(*rootNode);
-	*rootNode = NULL;
+void removeNodeChildren(json** children, long long count, arraylist* pending)
+{
+	long long length = (pending == NULL) ? 0 : pending->length;
+	if((pending != NULL) && arraylistGrow(pending, count))
+	{
+		json** stack = (json**) pending->data;
+		for(long long i = 0; i < count; i++)
+			if((children[i]->type & json_VIEW) != json_VIEW)stack[length++] = children[i];
+		pending->length = length;
+		return;
+	}
+	//adopted views own nothing and are freed with their array's block
+
+	for(long long i = 0; i < count; i++)
+		json_removeNodeTree(children + i);
+	//without room on the stack, falls back to recursing
 	return;
-}
+}//queues a container's children to be freed
 
 char isWhitespace(char ws)
 {
@@ -564,123 +1513,85 @@ char isHex(char hex)
 	return retval;
 }
 
-int makeNumberFromJson(int type, filecopy* filec, int offset, json* outVar)
+long long makeNumberFromJson(int type, filecopy* filec, long long offset, json* outVar)
 {
-	//the exponent
-	int exponent = 0;
-	
-	int sign = (filec->bytes[offset] == '-') ? -1 : 1;
-
-	if(sign == -1)offset++;//in case of negative
-
-	int retLen = 0;
+	long long len = numberLen(filec->bytes + offset, filec->len - offset);
 
-	if((type & json_EXPONENT) == json_EXPONENT)
+	if((type & json_DECIMAL) == json_DECIMAL)
 	{
-		char expStarted = 0;
-		char expSign = 1;
-		for(int i = 0; (i + offset) < filec->len; i++)
-		{
-			retLen++;
-			expStarted |= ((filec->bytes[i + offset] | 0x20) == 'e');
-			if(expStarted == 0)continue;
-			
-			if((filec->bytes[i + offset] & ~0x20) == 'E')
-			{
-				if(filec->bytes[i + 1 + offset] == '-')
-				{
-					expSign = -1;
-					i++, retLen++;
-				}
-				if(filec->bytes[i + 1 + offset] == '+')i++, retLen++;
-				continue;
-			}
-
-			if(
-				!((filec->bytes[offset + i] >= '0') && 
-				(filec->bytes[offset + i] <= '9'))
-			) break;
+		outVar->data.fraction = strtod(filec->bytes + offset, NULL);
+	} else
+	{
+		char negative = filec->bytes[offset] == '-';
+		unsigned long long number = 0;
+		for(long long i = negative; i < len; i++)
+			number = (number * 10) + (filec->bytes[offset + i] - '0');
 
-			exponent *= 10;
-			
-			exponent += filec->bytes[i + offset] - '0';
-		}
-		exponent *= expSign;
+		outVar->data.number = (long long) (negative ? (0 - number) : number);
 	}
+	//the number is followed by a delimiter or the null terminator, so strtod stops at its end
 
-	if((type & json_DECIMAL) == json_DECIMAL)
-	{
-		outVar->data.fraction = 0;
-		char passedDecimal = 0;
-		
-		for(int i = 0; (i + offset) < filec->len; i++)
-		{
-			if((i + 1) > retLen)retLen = (i + 1);
+	return len - 1;
+}
 
-			if(filec->bytes[offset + i] == '.')
-			{
-				passedDecimal = 1;
-				continue;
-			}
+long long numberLen(const char* text, long long max)
+{
+	long long retVal = 0;
+	while(
+		(retVal < max) && (
+			((text[retVal] >= '0') && (text[retVal] <= '9')) ||
+			(text[retVal] == '-') || (text[retVal] == '+') ||
+			(text[retVal] == '.') || ((text[retVal] | 0x20) == 'e')
+		)
+	) retVal++;
 
-			if((filec->bytes[i + offset] >= '0') && (filec->bytes[i + offset] <= '9'))
-			{
-				if(passedDecimal > 0)passedDecimal++;
-				outVar->data.fraction *= 10;
-				outVar->data.fraction += filec->bytes[offset + i] - '0';
-			} else break;
-		}//gets the data for the number
+	return retVal;
+}
 
-		for(int i = 0; i < passedDecimal - 1 - exponent; i++)
-		{
-			outVar->data.fraction /= 10;
-		}//scales the number to account for the decimal place
+void lazyConvert(json* node)
+{
+	filecopy text = {numberLen(node->data.lazy.text, LLONG_MAX), node->data.lazy.text, parse_LAZY, NULL};
+	makeNumberFromJson(node->type, &text, 0, node);
+	node->type |= json_LAZYDONE;
+	//the value is written over lazy.value, so the text is kept
+}//converts a lazy number
 
-		if((passedDecimal - 1 - exponent) < 0)
-		{
-			for(int i = 0; i < (1 + exponent - passedDecimal); i++)
-			{
-				outVar->data.fraction *= 10;
-			}
-		}
-	} else
-	{
-		retLen = 0; 
-		outVar->data.number = 0;
-		for(int i = 0; (i + offset) < filec->len; i++)
-		{
-			retLen++;
-			if((filec->bytes[i + offset] >= '0') && (filec->bytes[i + offset] <= '9'))
-			{
-				outVar->data.number *= 10;
-				outVar->data.number += filec->bytes[offset + i] - '0';
-			} else break;
-		}
-	}
+void lazyConvertTree(json* node)
+{
+	if((node->type & (json_LAZY | json_LAZYDONE)) == json_LAZY)lazyConvert(node);
+	if((node->type & json_PACKED) != 0)return;
+	if(((node->type & json_ARRAY) != json_ARRAY) && ((node->type & json_OBJECT) != json_OBJECT))return;
 
-	return retLen - 2;
-}
+	json_iter iter = json_iterMake(node);
+	while(json_iterNext(&iter))lazyConvertTree(iter.value);
+}//converts every lazy number in a tree
 
-int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar)
+long long makeStringFromJson(int type, filecopy* filec, long long offset, json* outVar)
 {
 
 	if((type & json_EMPTYSTRING) == json_EMPTYSTRING)
 	{
-		outVar->data.string = (char*) malloc(sizeof(char));
-		outVar->data.string[0] = '\0';
+		outVar->type |= json_INLINE;
+		outVar->data.small[0] = '\0';
+		outVar->data.small[sizeof(outVar->data.small) - 1] = sizeof(outVar->data.small) - 1;
 		return 1;
 	}//if the string is empty, makes an empty string
 
-	int len = 0;//the length of the string
+	long long len = 0;//the length of the string
 	
 	offset++;//goes past the first "
 	
 	char temp;
-	for(int i = 0; (i + offset) < filec->len; i++)
+	char closed = 0;
+	for(long long i = 0; (i + offset) < filec->len; i++)
 	{
 		temp = filec->bytes[i + offset];
 		
-		if(temp == '"')break;
+		if(temp == '"')
+		{
+			closed = 1;
+			break;
+		}
 		
 		if(temp == '\\')
 		{
@@ -738,26 +1649,60 @@ int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar)
 		len++;
 	}
 
-	outVar->data.string = (char*) malloc(sizeof(char) * (len + 1));
-	outVar->data.string[len] = '\0';
+	if(!closed)
+	{
+		outVar->type = json_INVALID;
+		return 1;
+	}
+	//the file ended before the string did
+
+	if((filec->flags & parse_LIMITS) == parse_LIMITS)
+	{
+		parseBudget* budget = filec->budget;
+		if((budget->limits.maxStringLen > 0) && (len > budget->limits.maxStringLen))
+		{
+			if(budget->code == json_OK)budget->code = json_ERR_STRINGLEN, budget->offset = offset - 1;
+			outVar->type = json_INVALID;
+			return 1;
+		}
+		if(!budgetSpend(filec, 0, len + 1, offset - 1))
+		{
+			outVar->type = json_INVALID;
+			return 1;
+		}
+	}
+	//strings are measured before anything is allocated for them
 
-	//allocates mem for string
+	char* dest;
+	if(len < (long long) sizeof(outVar->data.small))
+	{
+		outVar->type |= json_INLINE;
+		dest = outVar->data.small;
+		outVar->data.small[sizeof(outVar->data.small) - 1] = sizeof(outVar->data.small) - 1 - len;
+	} else
+	{
+		outVar->data.str.string = (char*) malloc(sizeof(char) * (len + 1));
+		outVar->data.str.len = len;
+		dest = outVar->data.str.string;
+	}
+	dest[len] = '\0';
+	//short strings go in the node, so they don't need an allocation of their own
 
-	int charIndex = 0;
+	long long charIndex = 0;
 	//used to detirmine where in the output string a character is being assigned to
 	
-	int retLen = 0;//the length of the string in the json file
+	long long retLen = 0;//the length of the string in the json file
 
 	//data to the string
 	for(
-		int i = 0;
+		long long i = 0;
 		((i + offset) < filec->len) && (len > charIndex);
 		charIndex++, retLen++, i++
 	)
 	{
 		if(filec->bytes[i + offset] != '\\')
 		{
-			outVar->data.string[charIndex] = filec->bytes[i + offset];
+			dest[charIndex] = filec->bytes[i + offset];
 			continue;
 		}
 
@@ -765,21 +1710,21 @@ int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar)
 		retLen++;
 
 		if (filec->bytes[i + offset] == '"')
-			outVar->data.string[charIndex] = '"';
+			dest[charIndex] = '"';
 		else if (filec->bytes[i + offset] == '/')
-			outVar->data.string[charIndex] = 0x5c;
+			dest[charIndex] = 0x5c;
 		else if (filec->bytes[i + offset] == '\\')
-			outVar->data.string[charIndex] = 0x2f;
+			dest[charIndex] = 0x2f;
 		else if (filec->bytes[i + offset] == 'b')
-			outVar->data.string[charIndex] = 0x08;
+			dest[charIndex] = 0x08;
 		else if (filec->bytes[i + offset] == 'f')
-			outVar->data.string[charIndex] = 0x0c;
+			dest[charIndex] = 0x0c;
 		else if (filec->bytes[i + offset] == 'n')
-			outVar->data.string[charIndex] = 0x0a;
+			dest[charIndex] = 0x0a;
 		else if (filec->bytes[i + offset] == 'r')
-			outVar->data.string[charIndex] = 0x0d;
+			dest[charIndex] = 0x0d;
 		else if (filec->bytes[i + offset] == 't')
-			outVar->data.string[charIndex] = 0x09;
+			dest[charIndex] = 0x09;
 		else if (filec->bytes[i + offset] == 'u')
 		{
 			if (
@@ -787,13 +1732,13 @@ int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar)
 				(filec->bytes[i + offset + 2] != '0')
 			)//if the first 2 hex chars are null, 
 			{
-				outVar->data.string[charIndex] = 
+				dest[charIndex] = 
 					(getHex(filec->bytes[i + 1 + offset]) << 4) | 
 					getHex(filec->bytes[i + 2 + offset]);
 				charIndex++;
 			}
 				
-			outVar->data.string[charIndex] = 
+			dest[charIndex] = 
 				(getHex(filec->bytes[i + 3 + offset]) << 4) | 
 				getHex(filec->bytes[i + 4 + offset]);
 
@@ -803,13 +1748,23 @@ int makeStringFromJson(int type, filecopy* filec, int offset, json* outVar)
 		{
 			i--;
 			retLen--;
-			outVar->data.string[charIndex] = '\\';
+			dest[charIndex] = '\\';
 		}
 	}//gets data from the string
 	
 	return retLen + 1;
 }
 
+char* stringTake(json* node)
+{
+	if((node->type & json_INLINE) != json_INLINE)return node->data.string;
+
+	size_t len = sizeof(node->data.small) - 1 - node->data.small[sizeof(node->data.small) - 1];
+	char* retVal = (char*) malloc(sizeof(char) * (len + 1));
+	memcpy(retVal, node->data.small, len + 1);
+	return retVal;
+}//takes the string out of a node
+
 char getHex(char hex)
 {
 	if(hex <= '9')return hex - '0';
@@ -819,7 +1774,7 @@ char getHex(char hex)
 
 char stringCompare(char* str1, char* str2)
 {
-	int i = 0;
+	long long i = 0;
 	while(1)
 	{
 		if((str1[i] == 0) && (str2[i] == 0))
@@ -834,11 +1789,17 @@ char stringCompare(char* str1, char* str2)
 }
 
 int json_getInt(json* val)
+{
+	return (int) json_getInt64(val);
+}
+
+long long json_getInt64(json* val)
 {
 	if(val == NULL)return 0;
+	if((val->type & (json_LAZY | json_LAZYDONE)) == json_LAZY)lazyConvert(val);
 	if((val->type & json_NUMBER) == json_NUMBER)
 	{
-		if((val->type & json_DECIMAL) == json_DECIMAL)return (int) val->data.fraction;
+		if((val->type & json_DECIMAL) == json_DECIMAL)return (long long) val->data.fraction;
 		return val->data.number;
 	}
 	return 0;
@@ -847,6 +1808,7 @@ int json_getInt(json* val)
 double json_getDouble(json* val)
 {
 	if(val == NULL)return 0.0;
+	if((val->type & (json_LAZY | json_LAZYDONE)) == json_LAZY)lazyConvert(val);
 	if((val->type & json_NUMBER) == json_NUMBER)
 	{
 		if((val->type & json_DECIMAL) != json_DECIMAL)return (double) val->data.number;
@@ -855,49 +1817,228 @@ double json_getDouble(json* val)
 	return 0.0;
 }
 
+const char* json_getNumberText(json* val, size_t* len)
+{
+	if((val == NULL) || ((val->type & json_LAZY) != json_LAZY))return NULL;
+
+	if(len != NULL)*len = numberLen(val->data.lazy.text, LLONG_MAX);
+	return val->data.lazy.text;
+}
+
 char* json_getString(json* val)
 {
 	if(val == NULL)return NULL;
+	if((val->type & (json_STRING | json_INLINE)) == (json_STRING | json_INLINE))return val->data.small;
 	if((val->type & json_STRING) == json_STRING)
 	{
-		return val->data.string;
+		return (char*) resolvePtr(
+			(val->type & json_MAPPED) == json_MAPPED, (void**) &(val->data.string)
+		);
 	}
 	return NULL;
 }
 
+const char* json_getStringLen(json* val, size_t* len)
+{
+	if((val == NULL) || ((val->type & json_STRING) != json_STRING))return NULL;
+
+	if((val->type & json_INLINE) == json_INLINE)
+	{
+		if(len != NULL)*len = sizeof(val->data.small) - 1 - val->data.small[sizeof(val->data.small) - 1];
+		return val->data.small;
+	}
+	//the last byte of an inline string is 15 minus its length
+
+	if(len != NULL)*len = val->data.str.len;
+	return json_getString(val);
+}
+
 json* json_getIndex(json* val, int index)
+{
+	if(index < 0)return NULL;
+	return json_getIndex64(val, index);
+}
+
+json* json_getIndex64(json* val, size_t index)
 {
 	if(val == NULL)return NULL;
+	if((val->type & json_PACKED) != 0)return packedView(val, index);
+
 	if((val->type & json_ARRAY) == json_ARRAY)
 	{
-		return ((json**)val->data.array->data)[index];
+		char mapped = (val->type & json_MAPPED) == json_MAPPED;
+		arraylist* arr = (arraylist*) resolvePtr(mapped, (void**) &(val->data.array));
+		return (json*) resolvePtr(mapped, ((void**) resolvePtr(mapped, &(arr->data))) + index);
 	}
 	return NULL;
 }
 
 json* json_getMember(json* val, char* memberName)
 {
-	if(val == NULL)return NULL;
 	if(memberName == NULL)return NULL;
+	return json_getMemberLen(val, memberName, strlen(memberName));
+}
+
+json* json_getMemberLen(json* val, const char* memberName, size_t len)
+{
+	if(val == NULL)return NULL;
+	long long index = findMember(val, memberName, len);
+	if(index < 0)return NULL;
+	return json_objectValueAt(val, index);
+}
+
+long long findMember(json* val, const char* memberName, size_t len)
+{
+	if((val == NULL) || (memberName == NULL))return -1;
+	if((val->type & json_OBJECT) != json_OBJECT)return -1;
+
+	char mapped = (val->type & json_MAPPED) == json_MAPPED;
+	arraylist* keys = (arraylist*) resolvePtr(mapped, (void**) &(val->data.object.keys));
+	json_key* keySlots = (json_key*) resolvePtr(mapped, &(keys->data));
+
+	for(long long i = 0; i < keys->length; i++)
+	{
+		if(keySlots[i].len != len)continue;
+		if(memcmp(resolvePtr(mapped, (void**) &(keySlots[i].string)), memberName, len) == 0)return i;
+	}
+	//the stored lengths rule out most keys without reading them
+
+	return -1;
+}
+
+json_keyHandle json_keyHandleMake(const char* memberName)
+{
+	json_keyHandle retVal = {memberName, (memberName == NULL) ? 0 : strlen(memberName), 0};
+	return retVal;
+}
+
+json* json_getMemberCached(json* val, json_keyHandle* handle)
+{
+	if((val == NULL) || (handle == NULL))return NULL;
+	if((val->type & json_OBJECT) != json_OBJECT)return NULL;
+
+	_Atomic(unsigned long long)* cachePtr = (_Atomic(unsigned long long)*) &(handle->cache);
+	unsigned long long cached = atomic_load_explicit(cachePtr, memory_order_relaxed);
+	_Atomic(int)* shapePtr = (_Atomic(int)*) &(val->shape);
+	int shape = atomic_load_explicit(shapePtr, memory_order_relaxed);
+
+	if((shape > 0) && ((cached >> 32) == (unsigned int) shape))
+		return ((json**) val->data.object.values->data)[cached & 0xffffffff];
+	//objects with the same shape have the key at the same index
+	//mapped objects never have a shape, so their pointers don't need resolving here
+
+	long long index = findMember(val, handle->name, handle->len);
+	if(index < 0)return NULL;
+
+	if((shape == 0) && ((val->type & json_MAPPED) != json_MAPPED))
+	{
+		shape = shapeOf(val->data.object.keys);
+		atomic_store_explicit(shapePtr, shape, memory_order_relaxed);
+	}
+	//the shape is only worked out the first time a handle looks in the object, so plain parses never touch the table
+	//threads reading a shared tree can race here, but they all store the same id
+
+	if(shape > 0)
+	{
+		atomic_store_explicit(
+			cachePtr, (((unsigned long long) (unsigned int) shape) << 32) | (unsigned long long) index, 
+			memory_order_relaxed
+		);
+	}
+	//the shape and index are stored together so other threads never see half of an update
+
+	return json_objectValueAt(val, index);
+}
+
+size_t json_objectSize(json* val)
+{
+	if(val == NULL)return 0;
 	if((val->type & json_OBJECT) == json_OBJECT)
 	{
-		for(int i = 0; i < val->data.object.keys->length; i++)
-		{
-			if(stringCompare(((char**)val->data.object.keys->data)[i], memberName))
-				return ((json**)val->data.object.values->data)[i];
-		}
+		return ((arraylist*) resolvePtr(
+			(val->type & json_MAPPED) == json_MAPPED, (void**) &(val->data.object.keys)
+		))->length;
 	}
-	return NULL;
+	return 0;
+}
+
+char* json_objectKeyAt(json* val, size_t index, size_t* len)
+{
+	if(index >= json_objectSize(val))return NULL;
+
+	char mapped = (val->type & json_MAPPED) == json_MAPPED;
+	arraylist* keys = (arraylist*) resolvePtr(mapped, (void**) &(val->data.object.keys));
+	json_key* key = ((json_key*) resolvePtr(mapped, &(keys->data))) + index;
+
+	if(len != NULL)*len = key->len;
+	return (char*) resolvePtr(mapped, (void**) &(key->string));
+}
+
+json* json_objectValueAt(json* val, size_t index)
+{
+	if(index >= json_objectSize(val))return NULL;
+
+	char mapped = (val->type & json_MAPPED) == json_MAPPED;
+	arraylist* values = (arraylist*) resolvePtr(mapped, (void**) &(val->data.object.values));
+	return (json*) resolvePtr(mapped, ((void**) resolvePtr(mapped, &(values->data))) + index);
+}
+
+json_iter json_iterMake(json* val)
+{
+	json_iter retVal = {val, 0, (size_t) -1, NULL, 0, NULL};
+
+	if(json_isObject(val))retVal.length = json_objectSize(val);
+	else retVal.length = json_arrayLen64(val);
+
+	return retVal;
+}
+
+char json_iterNext(json_iter* iter)
+{
+	if((iter == NULL) || (iter->index + 1 >= iter->length))
+	{
+		if(iter != NULL)iter->index = iter->length;
+		return 0;
+	}
+	//index starts at -1, so the first call moves to 0
+
+	iter->index++;
+	json* val = iter->container;
+
+	if((val->type & json_OBJECT) != json_OBJECT)
+	{
+		iter->value = json_getIndex64(val, iter->index);
+		return 1;
+	}
+
+	char mapped = (val->type & json_MAPPED) == json_MAPPED;
+	arraylist* keys = (arraylist*) resolvePtr(mapped, (void**) &(val->data.object.keys));
+	arraylist* values = (arraylist*) resolvePtr(mapped, (void**) &(val->data.object.values));
+	json_key* key = ((json_key*) resolvePtr(mapped, &(keys->data))) + iter->index;
+
+	iter->key = (char*) resolvePtr(mapped, (void**) &(key->string));
+	iter->keyLen = key->len;
+	iter->value = (json*) resolvePtr(mapped, ((void**) resolvePtr(mapped, &(values->data))) + iter->index);
+	return 1;
 }
 
 int json_arrayLen(json* val)
+{
+	if(val == NULL)return 0;
+	if((val->type & json_ARRAY) == json_ARRAY)return json_arrayLen64(val);
+	return -1;
+}
+
+size_t json_arrayLen64(json* val)
 {
 	if(val == NULL)return 0;
 	if((val->type & json_ARRAY) == json_ARRAY)
 	{
-		return val->data.array->length;
+		return ((arraylist*) resolvePtr(
+			(val->type & json_MAPPED) == json_MAPPED, (void**) &(val->data.array)
+		))->length;
 	}
-	return -1;
+	return 0;
 }
 
 char json_getBool(json* val)
@@ -958,87 +2099,436 @@ char json_isInvalid(json* val)
 	return (val->type & json_INVALID) == json_INVALID;
 }
 
-//arraylist functions
+//mutation functions
 
-arraylist* arraylistMake(int typeSize, int arrLength)
+json* makeNode(int type)
 {
-	arraylist* retVal = (arraylist*) malloc(sizeof(arraylist));
+	json* retVal = (json*) malloc(sizeof(json));
 	if(retVal == NULL)return NULL;
-	//mallocs mem for the arraylist
-	
-	retVal->length = arrLength;
-	retVal->size = typeSize;
-	if(typeSize * arrLength > 0)
-		retVal->data = malloc(typeSize * arrLength * sizeof(char));
-	else retVal->data = NULL;
-	//sets initial vals
-	
+
+	retVal->type = type;
 	return retVal;
-}//makes an arraylist
+}//makes a node
 
-void arraylistRemove(arraylist** arrList)
+json* json_newString(char* str)
 {
-	if((*arrList)->data != NULL)
-		free((*arrList)->data);
-	free((*arrList));
-	return;
-}//frees an arraylist
+	if(str == NULL)return NULL;
 
-void arraylistGrow(arraylist* arrList, int resizeAmount)
-{
-	if(resizeAmount == 0)return;
-	//returns if resize amount is 0
+	long long len = strlen(str);
+	json* retVal = makeNode((len == 0) ? json_EMPTYSTRING : json_STRING);
+	if(retVal == NULL)return NULL;
 
-	if(
-		(arrList->size * sizeof(char) * arrList->length) + (sizeof(char) + resizeAmount)
-		< 1)
+	if(len < (long long) sizeof(retVal->data.small))
 	{
-		if(arrList->data != NULL)
-			free(arrList->data);
-		arrList->data = NULL;
-		return;
+		retVal->type |= json_INLINE;
+		memcpy(retVal->data.small, str, len + 1);
+		retVal->data.small[sizeof(retVal->data.small) - 1] = sizeof(retVal->data.small) - 1 - len;
+		return retVal;
 	}
-	//incase the target length is 0 or less
+	//short strings are kept in the node, like the parser does
 
-	char* holder = (char*) malloc(
-		(arrList->size * sizeof(char) * arrList->length) + (sizeof(char) + resizeAmount)
-	);
-	//holder holds data
-	
-	int loopSize = ((resizeAmount > 0) ? 
-		arrList->size * sizeof(char) * arrList->length : 
-		arrList->size * sizeof(char) * arrList->length + (sizeof(char) + resizeAmount));
-	//self explanatory
-	
-	for(int i = 0; i < loopSize; i++)
+	retVal->data.str.string = (char*) malloc(sizeof(char) * (len + 1));
+	retVal->data.str.len = len;
+	if(retVal->data.str.string == NULL)
 	{
-		holder[i] = ((char*) arrList->data)[i];
-		//transfers data
+		free(retVal);
+		return NULL;
 	}
-	
-	if(arrList->data != NULL)
-		free(arrList->data);
-	arrList->data = (void*) holder;
-	//sets arrList->data to the transfered data
-	
-	arrList->length += resizeAmount;
-	return;
-}
+	memcpy(retVal->data.string, str, len + 1);
+	return retVal;
+}//makes a string
 
-void arraylistSetLength(arraylist *arrList, int newLength)
+json* json_newInt(int num)
 {
-	arraylistGrow(arrList, newLength - arrList->length);
-}//just a wrapper for arraylist_grow
+	return json_newInt64(num);
+}//makes an int
 
-void* arraylistGet(arraylist* arrList, int index)
+json* json_newInt64(long long num)
 {
-	if(arrList->data == NULL)return NULL;
-	return (void*) (((char*) arrList->data) + (index * arrList->size));
-}//gets a pointer to a val in the array list
+	json* retVal = makeNode((num < 0) ? json_NEGATIVE : json_NUMBER);
+	if(retVal == NULL)return NULL;
+
+	retVal->data.number = num;
+	return retVal;
+}//makes a 64 bit int
+
+json* json_newDouble(double num)
+{
+	json* retVal = makeNode((num < 0) ? (json_DECIMAL | json_NEGATIVE) : json_DECIMAL);
+	if(retVal == NULL)return NULL;
+
+	retVal->data.fraction = num;
+	return retVal;
+}//makes a double
+
+json* json_newBool(char boolean)
+{
+	json* retVal = makeNode(boolean ? json_TRUE : json_FALSE);
+	if(retVal == NULL)return NULL;
+
+	retVal->data.boolean = boolean ? 1 : 0;
+	return retVal;
+}//makes a boolean
+
+json* json_newNull(void)
+{
+	return makeNode(json_NULL);
+}//makes a null
+
+json* json_newArray(void)
+{
+	json* retVal = makeNode(json_EMPTYARRAY);
+	if(retVal == NULL)return NULL;
+
+	retVal->data.array = arraylistMake(sizeof(json*), 0);
+	if(retVal->data.array == NULL)
+	{
+		free(retVal);
+		return NULL;
+	}
+	return retVal;
+}//makes an array
+
+json* json_newObject(void)
+{
+	json* retVal = makeNode(json_EMPTYOBJECT);
+	if(retVal == NULL)return NULL;
+
+	retVal->data.object.keys = arraylistMake(sizeof(json_key), 0);
+	retVal->data.object.values = arraylistMake(sizeof(json*), 0);
+	if((retVal->data.object.keys == NULL) || (retVal->data.object.values == NULL))
+	{
+		if(retVal->data.object.keys != NULL)arraylistRemove(&(retVal->data.object.keys));
+		if(retVal->data.object.values != NULL)arraylistRemove(&(retVal->data.object.values));
+		free(retVal);
+		return NULL;
+	}
+	retVal->shape = 0;
+	return retVal;
+}//makes an object
+
+char canModify(json* val, int type)
+{
+	if(val == NULL)return 0;
+	if((val->type & type) != type)return 0;
+	return (val->type & (json_MAPPED | json_SHARED | json_FROZEN | json_EDITABLE | json_COMPACT)) == 0;
+	//snapshots, frozen trees and everything in them, and compact trees are read only, and editable trees are changed through their source
+}//checks if a container can be modified
+
+void updateEmptyFlag(json* val)
+{
+	long long length = ((val->type & json_ARRAY) == json_ARRAY) ? 
+		val->data.array->length : val->data.object.keys->length;
+
+	if(length == 0)val->type |= json_EMPTY;
+	else val->type &= ~json_EMPTY;
+}//keeps the empty flag in sync
+
+char json_setMember(json* val, char* memberName, json* value)
+{
+	if(!canModify(val, json_OBJECT) || (memberName == NULL) || (value == NULL))return 0;
+
+	long long len = strlen(memberName);
+	long long index = findMember(val, memberName, len);
+	if(index >= 0)
+	{
+		json_removeNodeTree(((json**) val->data.object.values->data) + index);
+		arraylistSet(val->data.object.values, index, &value);
+		return 1;
+	}
+	//replaces the value if the member already exists
+
+	json_key key = {(char*) malloc(sizeof(char) * (len + 1)), len};
+	if(key.string == NULL)return 0;
+	memcpy(key.string, memberName, len + 1);
+
+	if(!arraylistPush(val->data.object.keys, &key))
+	{
+		free(key.string);
+		return 0;
+	}
+	if(!arraylistPush(val->data.object.values, &value))
+	{
+		arraylistGrow(val->data.object.keys, -1);
+		free(key.string);
+		return 0;
+	}
+	//the key is taken back out if its value can't be added, so the lists stay the same length
+
+	updateEmptyFlag(val);
+	val->shape = 0;
+	//objects that are changed have their shape worked out again the next time a handle looks in them
+	return 1;
+}//sets a member
+
+char json_removeMember(json* val, char* memberName)
+{
+	if(!canModify(val, json_OBJECT) || (memberName == NULL))return 0;
+
+	long long index = findMember(val, memberName, strlen(memberName));
+	if(index < 0)return 0;
+
+	json_key key;
+	json* value;
+	arraylistRemoveAt(val->data.object.keys, index, &key);
+	arraylistRemoveAt(val->data.object.values, index, &value);
+	free(key.string);
+	json_removeNodeTree(&value);
+	updateEmptyFlag(val);
+	val->shape = 0;
+	return 1;
+}//removes a member
+
+char json_push(json* val, json* value)
+{
+	if(!canModify(val, json_ARRAY) || (value == NULL))return 0;
+	if(((val->type & json_PACKED) != 0) && !unpackArray(val))return 0;
+
+	if(!arraylistPush(val->data.array, &value))return 0;
+	updateEmptyFlag(val);
+	return 1;
+}//adds to the end of an array
+
+char json_insertAt(json* val, size_t index, json* value)
+{
+	if(!canModify(val, json_ARRAY) || (value == NULL))return 0;
+	if(((val->type & json_PACKED) != 0) && !unpackArray(val))return 0;
+	if(index > (size_t) val->data.array->length)return 0;
+
+	if(!arraylistInsert(val->data.array, index, &value))return 0;
+	updateEmptyFlag(val);
+	return 1;
+}//inserts into an array
+
+char json_removeAt(json* val, size_t index)
+{
+	if(!canModify(val, json_ARRAY))return 0;
+	if(((val->type & json_PACKED) != 0) && !unpackArray(val))return 0;
+	if(index >= (size_t) val->data.array->length)return 0;
+
+	json* value;
+	arraylistRemoveAt(val->data.array, index, &value);
+	json_removeNodeTree(&value);
+	updateEmptyFlag(val);
+	return 1;
+}//removes from an array
+
+//packed array functions
+
+int packedTypeOf(int type)
+{
+	return ((type & json_DECIMAL) == json_DECIMAL) ? json_PACKEDDOUBLE : json_PACKEDINT;
+}//gets the packed flag for a number type
+
+void makePackedView(json* outVar, arraylist* values, long long index, int packedType)
+{
+	if(packedType == json_PACKEDDOUBLE)
+	{
+		outVar->type = json_DECIMAL;
+		outVar->data.fraction = ((double*) values->data)[index];
+		return;
+	}
+
+	outVar->data.number = ((int64_t*) values->data)[index];
+	outVar->type = (outVar->data.number < 0) ? json_NEGATIVE : json_NUMBER;
+}//makes a node for a packed value
+
+char exactAsDouble(long long num)
+{
+	return (num >= -(1LL << 53)) && (num <= (1LL << 53));
+}//checks if an int survives being a double
+
+char packedPromote(arraylist* values, int* packedType, json* number, int numberType)
+{
+	if(numberType == *packedType)return 1;
+
+	if(numberType == json_PACKEDINT)
+	{
+		if(!exactAsDouble(number->data.number))return 0;
+		number->data.fraction = (double) number->data.number;
+		return 1;
+	}
+	//an int added to doubles becomes a double
+
+	int64_t* ints = (int64_t*) values->data;
+	for(long long i = 0; i < values->length; i++)
+	{
+		if(!exactAsDouble(ints[i]))return 0;
+	}
+
+	for(long long i = 0; i < values->length; i++)
+	{
+		double fraction = (double) ints[i];
+		memcpy(ints + i, &fraction, sizeof(double));
+	}
+	*packedType = json_PACKEDDOUBLE;
+	return 1;
+	//a double added to ints turns them all into doubles
+}//fits a number into packed values
+
+char appendUnpacked(arraylist* nodes, arraylist* values, int packedType)
+{
+	for(long long i = 0; i < values->length; i++)
+	{
+		json* node = (json*) malloc(sizeof(json));
+		if(node == NULL)return 0;
+		makePackedView(node, values, i, packedType);
+		if(!arraylistPush(nodes, &node))
+		{
+			free(node);
+			return 0;
+		}
+	}
+	return 1;
+}//turns packed values into nodes
+
+json* packedView(json* val, long long index)
+{
+	_Atomic(json*)* viewsPtr = (_Atomic(json*)*) &(val->data.packed.views);
+	json* views = atomic_load(viewsPtr);
+
+	if(views == NULL)
+	{
+		arraylist* values = val->data.packed.values;
+		json* fresh = (json*) malloc(sizeof(json) * values->length);
+		if(fresh == NULL)return NULL;
+
+		for(long long i = 0; i < values->length; i++)
+			makePackedView(fresh + i, values, i, val->type & json_PACKED);
+
+		json* expected = NULL;
+		if(atomic_compare_exchange_strong(viewsPtr, &expected, fresh))views = fresh;
+		else
+		{
+			free(fresh);
+			views = expected;
+		}
+		//another thread may have made the views first, in which case theirs are used
+	}
+
+	return views + index;
+}//gets a view of a packed value
+
+char unpackArray(json* val)
+{
+	arraylist* values = val->data.packed.values;
+	json* views = val->data.packed.views;
+	arraylist* nodes = arraylistMake(sizeof(json*), (views != NULL) ? values->length : 0);
+	if((nodes == NULL) || ((views != NULL) && (values->length > 0) && (nodes->data == NULL)))
+	{
+		if(nodes != NULL)arraylistRemove(&nodes);
+		return 0;
+	}
+
+	if(views != NULL)
+	{
+		json** slots = (json**) nodes->data;
+		for(long long i = 0; i < values->length; i++)
+		{
+			views[i].type |= json_VIEW;
+			slots[i] = views + i;
+		}
+		val->type |= json_ADOPTED;
+	} else if(!appendUnpacked(nodes, values, val->type & json_PACKED))
+	{
+		json** slots = (json**) nodes->data;
+		for(long long i = 0; i < nodes->length; i++)free(slots[i]);
+		arraylistRemove(&nodes);
+		return 0;
+	}
+	//views that exist may already be held by the caller, so they become the elements instead of new nodes
+	//they stay in one block, which is kept in views and freed with the array
+
+	arraylistRemove(&values);
+	val->data.array = nodes;
+	val->type &= ~json_PACKED;
+	return 1;
+}//unpacks an array
+
+double* json_getDoubleArray(json* val, long long* len)
+{
+	if((val == NULL) || ((val->type & json_PACKED) != json_PACKEDDOUBLE))return NULL;
+
+	if(len != NULL)*len = val->data.packed.values->length;
+	return (double*) val->data.packed.values->data;
+}//gets packed doubles
+
+int64_t* json_getInt64Array(json* val, long long* len)
+{
+	if((val == NULL) || ((val->type & json_PACKED) != json_PACKEDINT))return NULL;
+
+	if(len != NULL)*len = val->data.packed.values->length;
+	return (int64_t*) val->data.packed.values->data;
+}//gets packed ints
+
+//arraylist functions
+
+arraylist* arraylistMake(long long typeSize, long long arrLength)
+{
+	arraylist* retVal = (arraylist*) malloc(sizeof(arraylist));
+	if(retVal == NULL)return NULL;
+	//mallocs mem for the arraylist
+	
+	retVal->length = arrLength;
+	retVal->capacity = arrLength;
+	retVal->size = typeSize;
+	if(typeSize * arrLength > 0)
+		retVal->data = malloc((size_t) (typeSize * arrLength));
+	else retVal->data = NULL;
+	//sets initial vals
+	
+	return retVal;
+}//makes an arraylist
+
+void arraylistRemove(arraylist** arrList)
+{
+	if((*arrList)->data != NULL)
+		free((*arrList)->data);
+	free((*arrList));
+	return;
+}//frees an arraylist
+
+char arraylistGrow(arraylist* arrList, long long resizeAmount)
+{
+	if(resizeAmount == 0)return 1;
+	//returns if resize amount is 0
+
+	long long newLength = arrList->length + resizeAmount;
+	if(newLength < 0)newLength = 0;
+	//incase the target length is less than 0
 
-void arraylistSet(arraylist* arrList, int index, void* value)
+	if(newLength > arrList->capacity)
+	{
+		long long newCapacity = (arrList->capacity < 4) ? 4 : arrList->capacity;
+		while(newCapacity < newLength)newCapacity *= 2;
+		//grows geometrically so that pushing is amortized O(1)
+
+		void* holder = realloc(arrList->data, (size_t) newCapacity * arrList->size);
+		if(holder == NULL)return 0;
+
+		arrList->data = holder;
+		arrList->capacity = newCapacity;
+	}
+	//shrinking never reallocates
+
+	arrList->length = newLength;
+	return 1;
+}
+
+char arraylistSetLength(arraylist *arrList, long long newLength)
+{
+	return arraylistGrow(arrList, newLength - arrList->length);
+}//just a wrapper for arraylist_grow
+
+void* arraylistGet(arraylist* arrList, long long index)
+{
+	if(arrList->data == NULL)return NULL;
+	return (void*) (((char*) arrList->data) + (index * arrList->size));
+}//gets a pointer to a val in the array list
+
+void arraylistSet(arraylist* arrList, long long index, void* value)
 {
-	for(int i = 0; i < arrList->size; i++)
+	for(long long i = 0; i < arrList->size; i++)
 	{
 		((char*) arrList->data)[i + (index * arrList->size)] = ((char*) value)[i];
 		//copies data
@@ -1046,16 +2536,40 @@ void arraylistSet(arraylist* arrList, int index, void* value)
 	return;
 }//sets a value in the arraylist
 
-void arraylistPush(arraylist* arrList, void* value)
+char arraylistPush(arraylist* arrList, void* value)
 {
-	arraylistGrow(arrList, 1);
+	if(!arraylistGrow(arrList, 1))return 0;
 	arraylistSet(arrList, arrList->length - 1, value);
-	return;
+	return 1;
 }//grows the arraylist and sets the new index to value
 
+char arraylistInsert(arraylist* arrList, long long index, void* value)
+{
+	if(!arraylistGrow(arrList, 1))return 0;
+	memmove(
+		((char*) arrList->data) + ((index + 1) * arrList->size),
+		((char*) arrList->data) + (index * arrList->size),
+		(arrList->length - 1 - index) * arrList->size
+	);
+	arraylistSet(arrList, index, value);
+	return 1;
+}//makes room for a value and sets it
+
+void arraylistRemoveAt(arraylist* arrList, long long index, void* output)
+{
+	memcpy(output, ((char*) arrList->data) + (index * arrList->size), arrList->size);
+	memmove(
+		((char*) arrList->data) + (index * arrList->size),
+		((char*) arrList->data) + ((index + 1) * arrList->size),
+		(arrList->length - 1 - index) * arrList->size
+	);
+	arraylistGrow(arrList, -1);
+	return;
+}//takes a value out of the arraylist
+
 void arraylistPop(arraylist* arrList, void* output)
 {
-	for(int i = 0; i < arrList->size; i++)
+	for(long long i = 0; i < arrList->size; i++)
 	{
 		((char*) output)[i] = 
 			((char*) arrList->data)[i + ((arrList->length - 1) * arrList->size)];
@@ -1068,11 +2582,8 @@ void arraylistPop(arraylist* arrList, void* output)
 
 filecopy* filecopyMake(char* path)
 {
-	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
-	//the return value
-
 	FILE* filePtr;
-	filePtr = fopen(path, "r");
+	filePtr = fopen(path, "rb");
 	//opens the file
 
 	if(filePtr == NULL)
@@ -1082,23 +2593,7 @@ filecopy* filecopyMake(char* path)
 	}
 	//if the file can't be opened
 
-	fseek(filePtr, 0L, SEEK_END);
-	retVal->len = ftell(filePtr);
-	rewind(filePtr);
-	//finds the length of the file
-
-	retVal->bytes = (char*) malloc(sizeof(char) * (retVal->len + 1));
-	//allocates bytes for the file
-
-	char tempChar;//just a temporary char
-
-	for(long long i = 0L; (tempChar = fgetc(filePtr)) != EOF; i++)
-	{
-		retVal->bytes[i] = tempChar;
-	}
-	//copies the file
-	
-	retVal->bytes[retVal->len] = 0;
+	filecopy* retVal = filecopyMakeFromFilePtr(filePtr);
 
 	fclose(filePtr);//closes the file
 
@@ -1107,38 +2602,3395 @@ filecopy* filecopyMake(char* path)
 
 filecopy* filecopyMakeFromFilePtr(FILE* filePtr)
 {
-	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
-	//the return value
-
 	if(filePtr == NULL)return NULL;
 	//if the file can't be opened
 
-	fseek(filePtr, 0L, SEEK_END);
-	retVal->len = ftell(filePtr);
-	rewind(filePtr);
-	//finds the length of the file
+	struct stat fileStat;
+	if(fstat(fileno(filePtr), &fileStat) != 0)return NULL;
+
+	if(!S_ISREG(fileStat.st_mode))return filecopyMakeFromStream(filePtr);
+	//pipes, sockets and terminals can't be sized or rewound
+
+	off_t start = ftello(filePtr);
+	if(start < 0)return NULL;
+	//the caller may have already read part of the file, so it is read from where the FILE is
+
+	unsigned char magic[4] = {0, 0, 0, 0};
+	ssize_t magicLen = pread(fileno(filePtr), magic, 4, start);
+	//peeks at the first bytes to see if the file is compressed
+
+	int format = filecopyFormatOf(magic, magicLen);
+	if(format != filecopy_PLAIN)return filecopyDecompress(filePtr, format);
+	//pread doesn't move the FILE, so it is still at the start of the compressed data
+
+	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
+	if(retVal == NULL)return NULL;
+	//the return value
+
+	retVal->flags = 0;
+	retVal->len = (fileStat.st_size > start) ? fileStat.st_size - start : 0;
+	//finds the length of what is left of the file, ftell returns a long, which is only 32 bits on some platforms
 
 	retVal->bytes = (char*) malloc(sizeof(char) * (retVal->len + 1));
+	if(retVal->bytes == NULL)
+	{
+		free(retVal);
+		return NULL;
+	}
 	//allocates bytes for the file
 
-	char tempChar;//just a temporary char
+	long long done = 0;
+	while(done < retVal->len)
+	{
+		ssize_t got = pread(fileno(filePtr), retVal->bytes + done, retVal->len - done, start + done);
+		if((got < 0) && (errno == EINTR))continue;
+		if(got < 0)
+		{
+			filecopyRemove(&retVal);
+			return NULL;
+		}
+		if(got == 0)break;
+		done += got;
+	}
+	retVal->len = done;
+	//copies the file in as few reads as the kernel allows, the file may have shrunk since fstat
+	//a failed read gives no copy at all, rather than a truncated one
+
+	retVal->bytes[retVal->len] = 0;
+	fseek(filePtr, 0, SEEK_END);
+	//leaves the FILE ptr at the end, like reading it would
+
+	return retVal;
+}
+
+filecopy* filecopyMakeFromStream(FILE* filePtr)
+{
+	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
+	if(retVal == NULL)return NULL;
+
+	long long cap = filecopyBlockSize * 4;
+	retVal->bytes = (char*) malloc(cap);
+	retVal->len = 0;
+	retVal->flags = 0;
+	if(retVal->bytes == NULL)
+	{
+		free(retVal);
+		return NULL;
+	}
+
+	while(1)
+	{
+		if(cap - retVal->len - 1 < filecopyBlockSize)
+		{
+			char* holder = (char*) realloc(retVal->bytes, cap * 2);
+			if(holder == NULL)
+			{
+				filecopyRemove(&retVal);
+				return NULL;
+			}
+			retVal->bytes = holder;
+			cap *= 2;
+		}
+		//the buffer grows geometrically, always keeping room for the ending null
+
+		size_t want = cap - retVal->len - 1;
+		size_t got = fread(retVal->bytes + retVal->len, sizeof(char), want, filePtr);
+		retVal->len += got;
+		if(got < want)break;
+	}
+	//reads of more than the stdio buffer go straight to read(), anything already buffered is read first
 
-	for(long long i = 0L; (tempChar = fgetc(filePtr)) != EOF; i++)
+	if(ferror(filePtr))
 	{
-		retVal->bytes[i] = tempChar;
+		filecopyRemove(&retVal);
+		return NULL;
 	}
-	//copies the file
-	
+	//a short read is only the end of the stream if it wasn't an error
+
 	retVal->bytes[retVal->len] = 0;
 
+	int format = filecopyFormatOf((unsigned char*) retVal->bytes, retVal->len);
+	if(format == filecopy_PLAIN)return retVal;
+
+	filecopy* decompressed = filecopyDecompressBytes(retVal->bytes, retVal->len, format);
+	filecopyRemove(&retVal);
+	//the stream can't be read twice, so compressed input is decompressed from memory
+
+	return decompressed;
+}//reads a stream that can't be sized up front
+
+filecopy* filecopyDecompressBytes(char* bytes, long long len, int format)
+{
+	FILE* memPtr = fmemopen(bytes, len, "rb");
+	if(memPtr == NULL)return NULL;
+
+	filecopy* retVal = filecopyDecompress(memPtr, format);
+	fclose(memPtr);
+
 	return retVal;
-}//makes copies of files
+}//decompresses bytes in memory
 
-void filecopyRemove(filecopy** filec)
+int filecopyFormatOf(const unsigned char* magic, long long len)
 {
-	if((*filec)->bytes != NULL)
-		free((*filec)->bytes);
-	free(*filec);
-	*filec = NULL;
-	return;
-}//frees a filecopy
+	if((len >= 2) && (magic[0] == 0x1f) && (magic[1] == 0x8b))return filecopy_GZIP;
+
+	if(
+		(len >= 4) && (magic[0] == 0x28) && (magic[1] == 0xb5) &&
+		(magic[2] == 0x2f) && (magic[3] == 0xfd)
+	) return filecopy_ZSTD;
+
+	return filecopy_PLAIN;
+}//finds the format of a file from its first bytes
+
+filecopy* filecopyDecompress(FILE* filePtr, int format)
+{
+#ifndef JSON_ZLIB
+	if(format == filecopy_GZIP)
+	{
+		printf("gzip input needs the library to be built with JSON_ZLIB\n");
+		return NULL;
+	}
+#endif
+#ifndef JSON_ZSTD
+	if(format == filecopy_ZSTD)
+	{
+		printf("zstd input needs the library to be built with JSON_ZSTD\n");
+		return NULL;
+	}
+#endif
+	//a format that wasn't compiled in is reported as such, rather than as corrupt input
+
+#if defined(JSON_ZLIB) || defined(JSON_ZSTD)
+	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
+	if(retVal == NULL)return NULL;
+
+	unsigned char* inBlock = (unsigned char*) malloc(filecopyBlockSize);
+	long long cap = filecopyBlockSize * 4;
+	retVal->bytes = (char*) malloc(cap);
+	retVal->len = 0;
+	retVal->flags = 0;
+	if((inBlock == NULL) || (retVal->bytes == NULL))
+	{
+		free(inBlock);
+		free(retVal->bytes);
+		free(retVal);
+		return NULL;
+	}
+	//the output grows geometrically, always keeping room for the ending null
+
+	char failed = 0;
+	char finished = 0;
+#endif
+
+#ifdef JSON_ZLIB
+	if(format == filecopy_GZIP)
+	{
+		z_stream stream = {0};
+		inflateInit2(&stream, 15 + 32);
+		//15 + 32 lets zlib read the gzip header
+
+		while(!failed)
+		{
+			if(stream.avail_in == 0)
+			{
+				stream.avail_in = fread(inBlock, sizeof(char), filecopyBlockSize, filePtr);
+				stream.next_in = inBlock;
+				if(stream.avail_in == 0)break;
+			}
+
+			if(cap - retVal->len - 1 == 0)
+			{
+				char* holder = (char*) realloc(retVal->bytes, cap * 2);
+				if(holder == NULL)
+				{
+					failed = 1;
+					break;
+				}
+				retVal->bytes = holder;
+				cap *= 2;
+			}
+
+			stream.next_out = (unsigned char*) (retVal->bytes + retVal->len);
+			stream.avail_out = cap - retVal->len - 1;
+			int status = inflate(&stream, Z_NO_FLUSH);
+			retVal->len = cap - 1 - stream.avail_out;
+
+			if(status == Z_STREAM_END)
+			{
+				finished = 1;
+				inflateReset(&stream);
+				//gzip files can have more than one member
+				continue;
+			}
+			if((status != Z_OK) && (status != Z_BUF_ERROR))failed = 1;
+			finished = 0;
+		}
+		inflateEnd(&stream);
+	}
+#endif
+
+#ifdef JSON_ZSTD
+	if(format == filecopy_ZSTD)
+	{
+		ZSTD_DStream* stream = ZSTD_createDStream();
+		ZSTD_initDStream(stream);
+		ZSTD_inBuffer input = {inBlock, 0, 0};
+
+		while(!failed && (stream != NULL))
+		{
+			if(input.pos == input.size)
+			{
+				input.size = fread(inBlock, sizeof(char), filecopyBlockSize, filePtr);
+				input.pos = 0;
+				if(input.size == 0)break;
+			}
+
+			if(cap - retVal->len - 1 == 0)
+			{
+				char* holder = (char*) realloc(retVal->bytes, cap * 2);
+				if(holder == NULL)
+				{
+					failed = 1;
+					break;
+				}
+				retVal->bytes = holder;
+				cap *= 2;
+			}
+
+			ZSTD_outBuffer output = {retVal->bytes + retVal->len, cap - retVal->len - 1, 0};
+			size_t status = ZSTD_decompressStream(stream, &output, &input);
+			retVal->len += output.pos;
+
+			if(ZSTD_isError(status))failed = 1;
+			finished = (status == 0);
+			//0 means a whole frame has been read
+		}
+		if(stream == NULL)failed = 1;
+		ZSTD_freeDStream(stream);
+	}
+#endif
+
+#if defined(JSON_ZLIB) || defined(JSON_ZSTD)
+	free(inBlock);
+
+	if(failed || !finished)
+	{
+		printf("compressed input is corrupt or truncated\n");
+		filecopyRemove(&retVal);
+		return NULL;
+	}
+
+	retVal->bytes[retVal->len] = 0;
+	return retVal;
+#else
+	(void) filePtr;
+	return NULL;
+#endif
+}//decompresses a file into a filecopy
+
+filecopy* filecopyMakeFromBytes(char* bytes, long long len)
+{
+	filecopy* retVal = (filecopy*) malloc( sizeof(filecopy) );
+	if(retVal == NULL)return NULL;
+
+	retVal->bytes = (char*) malloc(sizeof(char) * (len + 1));
+	if(retVal->bytes == NULL)
+	{
+		free(retVal);
+		return NULL;
+	}
+
+	memcpy(retVal->bytes, bytes, len);
+	retVal->bytes[len] = 0;
+	retVal->len = len;
+	retVal->flags = 0;
+	//the parser relies on the ending null
+
+	return retVal;
+}//copies a buffer
+
+void filecopyRemove(filecopy** filec)
+{
+	if((*filec)->bytes != NULL)
+		free((*filec)->bytes);
+	free(*filec);
+	*filec = NULL;
+	return;
+}//frees a filecopy
+
+//snapshot functions
+
+void* resolvePtr(char mapped, void* const* field)
+{
+	if(!mapped)return *field;
+	if(*field == NULL)return NULL;
+	return (void*) (((char*) field) + (intptr_t) *field);
+}//turns an offset back into a pointer
+
+void storeRelPtr(void** field, void* target)
+{
+	if(target == NULL)
+	{
+		*field = NULL;
+		return;
+	}
+	*field = (void*) (((char*) target) - ((char*) field));
+}//turns a pointer into an offset
+
+void storePtr(char relative, void** field, void* target)
+{
+	if(relative)storeRelPtr(field, target);
+	else *field = target;
+}//stores a pointer either way
+
+char* snapshotAlloc(char* buf, long long* used, long long len)
+{
+	char* retVal = buf + *used;
+	*used += (len + 7) & ~7LL;
+	return retVal;
+}//reserves space in a snapshot
+
+long long treeSize(json* node, char relative)
+{
+	long long retVal = nodeSize(node, relative);
+
+	if(((node->type & json_PACKED) != 0) && !relative)return retVal;
+	//packed values are measured with their array
+
+	if((node->type & json_ARRAY) == json_ARRAY)
+	{
+		size_t length = json_arrayLen64(node);
+		for(size_t i = 0; i < length; i++)
+			retVal += treeSize(json_getIndex64(node, i), relative);
+	}
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		size_t length = json_objectSize(node);
+		for(size_t i = 0; i < length; i++)
+			retVal += treeSize(json_objectValueAt(node, i), relative);
+	}
+
+	return retVal;
+}//measures a tree
+
+long long nodeSize(json* node, char relative)
+{
+	char mapped = (node->type & json_MAPPED) == json_MAPPED;
+	long long retVal = (sizeof(json) + 7) & ~7LL;
+
+	if(((node->type & json_PACKED) != 0) && !relative)
+	{
+		arraylist* values = node->data.packed.values;
+		return retVal + ((sizeof(arraylist) + 7) & ~7LL) + ((values->length * values->size + 7) & ~7LL);
+	}
+	//packed arrays keep their values in one run
+
+	if((node->type & (json_STRING | json_INLINE)) == json_STRING)
+		retVal += (node->data.str.len + 1 + 7) & ~7LL;
+	//inline strings are already part of the node
+	//the stored length counts past any \u0000 in the string, which strlen would stop at
+
+	if((node->type & json_ARRAY) == json_ARRAY)
+		retVal += ((sizeof(arraylist) + 7) & ~7LL) + ((json_arrayLen64(node) * sizeof(json*) + 7) & ~7LL);
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		arraylist* keys = (arraylist*) resolvePtr(mapped, (void**) &(node->data.object.keys));
+		json_key* keySlots = (json_key*) resolvePtr(mapped, &(keys->data));
+
+		retVal += 2 * ((sizeof(arraylist) + 7) & ~7LL);
+		retVal += ((keys->length * sizeof(json_key) + 7) & ~7LL) + ((keys->length * sizeof(json*) + 7) & ~7LL);
+		for(long long i = 0; i < keys->length; i++)
+			retVal += (keySlots[i].len + 1 + 7) & ~7LL;
+	}
+
+	return retVal;
+}//measures a node without its children
+
+json* snapshotCopy(json* node, char* buf, long long* used, char relative, dedupTable* dedup)
+{
+	char mapped = (node->type & json_MAPPED) == json_MAPPED;
+
+	dedupEntry* entry = NULL;
+	if(dedup != NULL)
+	{
+		entry = dedup->entries + dedupFind(dedup, node);
+		if(entry->copy != NULL)return entry->copy;
+	}
+	//a value that was already copied is shared instead of being copied again
+
+	json* retVal = (json*) snapshotAlloc(buf, used, sizeof(json));
+	*retVal = *node;
+	if(entry != NULL)entry->copy = retVal;
+	retVal->type = (node->type & ~(json_SHARED | json_FROZEN | json_SPANNED | json_EDITABLE | json_SOURCED | json_LAZY | json_LAZYDONE | json_VIEW | json_ADOPTED)) | 
+		(relative ? json_MAPPED : json_COMPACT);
+	if(relative)retVal->type &= ~json_PACKED;
+	retVal->shape = relative ? 0 : node->shape;
+	if((node->type & (json_LAZY | json_LAZYDONE)) == json_LAZY)
+	{
+		filecopy text = {numberLen(node->data.lazy.text, LLONG_MAX), node->data.lazy.text, parse_LAZY, NULL};
+		makeNumberFromJson(node->type, &text, 0, retVal);
+	}
+	if((node->type & json_LAZY) == json_LAZY)retVal->data.lazy.text = NULL;
+	//lazy numbers are converted into the copy without touching the tree, and are written as plain numbers
+	//shape ids only mean something in the process that made them, so only compact trees keep them
+	//packed arrays stay packed in compact trees, but snapshots are read only so they are written out as arrays of nodes
+	//plain values are copied as is
+
+	if(((node->type & json_PACKED) != 0) && !relative)
+	{
+		arraylist* srcValues = node->data.packed.values;
+		long long len = srcValues->length * srcValues->size;
+		arraylist* values = (arraylist*) snapshotAlloc(buf, used, sizeof(arraylist));
+		char* data = snapshotAlloc(buf, used, len);
+
+		memcpy(data, srcValues->data, len);
+		values->size = srcValues->size;
+		values->length = srcValues->length;
+		values->capacity = srcValues->length;
+		values->data = (srcValues->length > 0) ? data : NULL;
+		retVal->data.packed.values = values;
+		retVal->data.packed.views = NULL;
+
+		((json*) buf)->type |= json_PACKEDBLOCK;
+		//views are made on demand outside the block, so the root, which is at the start of the block, has to free them
+		return retVal;
+	}
+
+	if((node->type & (json_STRING | json_INLINE)) == json_STRING)
+	{
+		char* str = json_getString(node);
+		long long len = node->data.str.len + 1;
+		char* strCopy = snapshotAlloc(buf, used, len);
+		memcpy(strCopy, str, len);
+		storePtr(relative, (void**) &(retVal->data.string), strCopy);
+	}
+
+	if((node->type & json_ARRAY) == json_ARRAY)
+	{
+		size_t length = json_arrayLen64(node);
+		arraylist* arr = (arraylist*) snapshotAlloc(buf, used, sizeof(arraylist));
+		void** slots = (void**) snapshotAlloc(buf, used, length * sizeof(json*));
+
+		arr->size = sizeof(json*);
+		arr->length = length;
+		arr->capacity = length;
+		storePtr(relative, (void**) &(retVal->data.array), arr);
+		retVal->data.packed.views = NULL;
+		storePtr(relative, &(arr->data), (length > 0) ? slots : NULL);
+
+		for(size_t i = 0; i < length; i++)
+			storePtr(relative, slots + i, snapshotCopy(json_getIndex64(node, i), buf, used, relative, dedup));
+	}
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		arraylist* srcKeys = (arraylist*) resolvePtr(mapped, (void**) &(node->data.object.keys));
+		arraylist* srcValues = (arraylist*) resolvePtr(mapped, (void**) &(node->data.object.values));
+		json_key* srcKeySlots = (json_key*) resolvePtr(mapped, &(srcKeys->data));
+		void** srcValueSlots = (void**) resolvePtr(mapped, &(srcValues->data));
+		long long length = srcKeys->length;
+
+		arraylist* keys = (arraylist*) snapshotAlloc(buf, used, sizeof(arraylist));
+		json_key* keySlots = (json_key*) snapshotAlloc(buf, used, length * sizeof(json_key));
+		arraylist* values = (arraylist*) snapshotAlloc(buf, used, sizeof(arraylist));
+		void** valueSlots = (void**) snapshotAlloc(buf, used, length * sizeof(json*));
+
+		keys->size = sizeof(json_key);
+		keys->length = length;
+		keys->capacity = length;
+		values->size = sizeof(json*);
+		values->length = length;
+		values->capacity = length;
+		storePtr(relative, (void**) &(retVal->data.object.keys), keys);
+		storePtr(relative, (void**) &(retVal->data.object.values), values);
+		storePtr(relative, &(keys->data), (length > 0) ? keySlots : NULL);
+		storePtr(relative, &(values->data), (length > 0) ? valueSlots : NULL);
+
+		for(long long i = 0; i < length; i++)
+		{
+			char* key = (char*) resolvePtr(mapped, (void**) &(srcKeySlots[i].string));
+			long long len = srcKeySlots[i].len + 1;
+			char* keyCopy = snapshotAlloc(buf, used, len);
+			memcpy(keyCopy, key, len);
+			storePtr(relative, (void**) &(keySlots[i].string), keyCopy);
+			keySlots[i].len = srcKeySlots[i].len;
+
+			storePtr(relative, 
+				valueSlots + i,
+				snapshotCopy((json*) resolvePtr(mapped, srcValueSlots + i), buf, used, relative, dedup)
+			);
+		}
+	}
+
+	return retVal;
+}//copies a tree into a snapshot
+
+char json_compact(json** doc)
+{
+	if((doc == NULL) || (*doc == NULL))return 0;
+	if(((*doc)->type & (json_MAPPED | json_SHARED | json_FROZEN | json_EDITABLE | json_COMPACT)) != 0)return 0;
+	//frozen trees have other owners, and snapshots are already one block
+
+	return compactTree(doc, treeSize(*doc, 0), NULL);
+}//moves a tree into one block
+
+char compactTree(json** doc, long long len, dedupTable* dedup)
+{
+	char* block = (char*) malloc(len);
+	if(block == NULL)return 0;
+
+	long long used = 0;
+	json* root = snapshotCopy(*doc, block, &used, 0, dedup);
+	//the same layout as a snapshot, each node followed by its own lists and strings and then its children
+	//the root is always copied first, so it is at the start of the block and json_remove can free it
+
+	json_remove(doc);
+	*doc = root;
+
+	return 1;
+}//copies a tree into a new block
+
+void compactViewsRemove(json* node)
+{
+	if((node->type & json_PACKED) != 0)
+	{
+		free(node->data.packed.views);
+		node->data.packed.views = NULL;
+		return;
+	}
+	//deduplicated arrays can be reached more than once, so the views are only freed the first time
+	if(((node->type & json_ARRAY) != json_ARRAY) && ((node->type & json_OBJECT) != json_OBJECT))return;
+
+	json_iter iter = json_iterMake(node);
+	while(json_iterNext(&iter))compactViewsRemove(iter.value);
+}//frees the views in a compact tree
+
+int json_saveSnapshot(json* val, char* pathToFile)
+{
+	if(val == NULL)return -1;
+
+	long long len = sizeof(snapshotHeader) + treeSize(val, 1);
+
+	char* buf = (char*) calloc(len, sizeof(char));
+	if(buf == NULL)return -1;
+	//zeroed so that padding bytes are deterministic
+
+	snapshotHeader* header = (snapshotHeader*) buf;
+	memcpy(header->magic, snapshotMagic, sizeof(snapshotMagic));
+	header->version = snapshotVersion;
+	header->ptrSize = sizeof(void*);
+	header->byteOrder = 1;
+	header->len = len;
+
+	long long used = sizeof(snapshotHeader);
+	snapshotCopy(val, buf, &used, 1, NULL);
+	//the root always starts directly after the header
+
+	FILE* filePtr = fopen(pathToFile, "wb");
+	if(filePtr == NULL)
+	{
+		printf("path \"%s\" is invalid\n", pathToFile);
+		free(buf);
+		return -1;
+	}
+
+	size_t written = fwrite(buf, sizeof(char), len, filePtr);
+	fclose(filePtr);
+	free(buf);
+
+	return (written == (size_t) len) ? 0 : -1;
+}//writes a snapshot
+
+json* json_loadSnapshot(char* pathToFile)
+{
+	int fd = open(pathToFile, O_RDONLY);
+	if(fd < 0)
+	{
+		printf("path \"%s\" is invalid\n", pathToFile);
+		return NULL;
+	}
+
+	struct stat fileStat;
+	if(
+		(fstat(fd, &fileStat) != 0) || 
+		(fileStat.st_size < (off_t) (sizeof(snapshotHeader) + sizeof(json)))
+	)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	void* map = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)return NULL;
+	//the mapping stays valid after the file is closed
+
+	snapshotHeader* header = (snapshotHeader*) map;
+	if(
+		(memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0) ||
+		(header->version != snapshotVersion) ||
+		(header->ptrSize != sizeof(void*)) ||
+		(header->byteOrder != 1) ||
+		(header->len != fileStat.st_size)
+	)
+	{
+		munmap(map, fileStat.st_size);
+		return NULL;
+	}
+	//snapshots are only valid on machines with the same layout as the one that wrote them
+
+	return (json*) (((char*) map) + sizeof(snapshotHeader));
+}//maps a snapshot
+
+//dedup functions
+
+long long countNodes(json* node)
+{
+	long long retVal = 1;
+	if((node->type & json_PACKED) != 0)return retVal;
+	//json_dedup treats a packed array as one value
+
+	if((node->type & json_ARRAY) == json_ARRAY)
+	{
+		size_t length = json_arrayLen64(node);
+		for(size_t i = 0; i < length; i++)
+			retVal += countNodes(json_getIndex64(node, i));
+	}
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		size_t length = json_objectSize(node);
+		for(size_t i = 0; i < length; i++)
+			retVal += countNodes(json_objectValueAt(node, i));
+	}
+
+	return retVal;
+}//counts nodes
+
+unsigned long long dedupMix(unsigned long long hash, unsigned long long value)
+{
+	hash = (hash ^ value) * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 29);
+}//mixes a hash
+
+long long dedupSlot(dedupTable* table, json* node)
+{
+	long long slot = (long long) (dedupMix(0, (unsigned long long) (uintptr_t) node) & table->nodeMask);
+	while((table->nodes[slot] != NULL) && (table->nodes[slot] != node))
+		slot = (slot + 1) & table->nodeMask;
+	return slot;
+}//finds a node's slot
+
+long long dedupFind(dedupTable* table, json* node)
+{
+	return table->nodeEntries[dedupSlot(table, node)];
+}//finds a node's entry
+
+char dedupEqual(dedupTable* table, json* a, json* b)
+{
+	if((a->type & 0x1FFF) != (b->type & 0x1FFF))return 0;
+	//only the kind of value matters, not how it is stored
+
+	if((a->type & json_STRING) == json_STRING)
+	{
+		size_t aLen = 0;
+		size_t bLen = 0;
+		const char* aStr = json_getStringLen(a, &aLen);
+		const char* bStr = json_getStringLen(b, &bLen);
+		return (aLen == bLen) && (memcmp(aStr, bStr, aLen) == 0);
+	}
+	//strings are compared by their stored length, so a \u0000 inside one doesn't end it early
+
+	if((a->type & json_DECIMAL) == json_DECIMAL)
+	{
+		double x = json_getDouble(a);
+		double y = json_getDouble(b);
+		return memcmp(&x, &y, sizeof(double)) == 0;
+	}
+	//compared bit for bit, so that 0.0 and -0.0 stay apart
+
+	if((a->type & json_NUMBER) == json_NUMBER)
+		return json_getInt64(a) == json_getInt64(b);
+
+	if((a->type & json_BOOLEAN) == json_BOOLEAN)
+		return json_getBool(a) == json_getBool(b);
+
+	if(((a->type & json_PACKED) != 0) || ((b->type & json_PACKED) != 0))
+	{
+		arraylist* aValues = a->data.packed.values;
+		arraylist* bValues = b->data.packed.values;
+		if(((a->type & json_PACKED) != (b->type & json_PACKED)) || (aValues->length != bValues->length))return 0;
+		return memcmp(aValues->data, bValues->data, aValues->length * aValues->size) == 0;
+	}
+	//packed arrays are compared by their values, and only to arrays packed the same way
+
+	if((a->type & json_ARRAY) == json_ARRAY)
+	{
+		size_t length = json_arrayLen64(a);
+		if(length != json_arrayLen64(b))return 0;
+		for(size_t i = 0; i < length; i++)
+			if(dedupFind(table, json_getIndex64(a, i)) != dedupFind(table, json_getIndex64(b, i)))return 0;
+		return 1;
+	}
+
+	if((a->type & json_OBJECT) == json_OBJECT)
+	{
+		size_t length = json_objectSize(a);
+		if(length != json_objectSize(b))return 0;
+		for(size_t i = 0; i < length; i++)
+		{
+			size_t aLen = 0;
+			size_t bLen = 0;
+			char* aKey = json_objectKeyAt(a, i, &aLen);
+			char* bKey = json_objectKeyAt(b, i, &bLen);
+			if((aLen != bLen) || (memcmp(aKey, bKey, aLen) != 0))return 0;
+			if(dedupFind(table, json_objectValueAt(a, i)) != dedupFind(table, json_objectValueAt(b, i)))return 0;
+		}
+		return 1;
+	}
+	//members have to be in the same order, so that the shared copy is the same when iterated
+
+	return 1;
+	//null and invalid have no value
+}//compares a node to an entry
+
+long long dedupVisit(dedupTable* table, json* node)
+{
+	unsigned long long hash = dedupMix(0, node->type & 0x1FFF);
+
+	if((node->type & json_STRING) == json_STRING)
+	{
+		size_t len = 0;
+		const unsigned char* str = (const unsigned char*) json_getStringLen(node, &len);
+		for(size_t i = 0; i < len; i++)hash = dedupMix(hash, str[i]);
+	}
+
+	if((node->type & json_DECIMAL) == json_DECIMAL)
+	{
+		double value = json_getDouble(node);
+		unsigned long long bits = 0;
+		memcpy(&bits, &value, sizeof(double));
+		hash = dedupMix(hash, bits);
+	} else if((node->type & json_NUMBER) == json_NUMBER)
+		hash = dedupMix(hash, (unsigned long long) json_getInt64(node));
+
+	if((node->type & json_BOOLEAN) == json_BOOLEAN)
+		hash = dedupMix(hash, json_getBool(node));
+
+	if((node->type & json_PACKED) != 0)
+	{
+		arraylist* values = node->data.packed.values;
+		unsigned long long* words = (unsigned long long*) values->data;
+		for(long long i = 0; i < values->length; i++)hash = dedupMix(hash, words[i]);
+	} else if((node->type & json_ARRAY) == json_ARRAY)
+	{
+		size_t length = json_arrayLen64(node);
+		for(size_t i = 0; i < length; i++)
+			hash = dedupMix(hash, table->entries[dedupVisit(table, json_getIndex64(node, i))].hash);
+	}
+
+	if((node->type & json_OBJECT) == json_OBJECT)
+	{
+		size_t length = json_objectSize(node);
+		for(size_t i = 0; i < length; i++)
+		{
+			size_t len = 0;
+			unsigned char* key = (unsigned char*) json_objectKeyAt(node, i, &len);
+			for(size_t j = 0; j < len; j++)hash = dedupMix(hash, key[j]);
+			hash = dedupMix(hash, table->entries[dedupVisit(table, json_objectValueAt(node, i))].hash);
+		}
+	}
+	//children are visited first, so a container's hash and comparison only need their entries
+
+	long long slot = dedupSlot(table, node);
+	long long bucket = (long long) (hash & table->bucketMask);
+	long long index = table->buckets[bucket];
+	while(index != -1)
+	{
+		dedupEntry* entry = table->entries + index;
+		if((entry->hash == hash) && dedupEqual(table, entry->node, node))break;
+		index = entry->next;
+	}
+
+	if(index == -1)
+	{
+		index = table->entryCount++;
+		table->entries[index] = (dedupEntry) {hash, node, NULL, table->buckets[bucket]};
+		table->buckets[bucket] = index;
+		table->size += nodeSize(node, 0);
+	}
+	//only the first node with a value takes up space in the block
+
+	table->nodes[slot] = node;
+	table->nodeEntries[slot] = index;
+	return index;
+}//finds a node's value
+
+char json_dedup(json** doc)
+{
+	if((doc == NULL) || (*doc == NULL))return 0;
+	if(((*doc)->type & (json_MAPPED | json_SHARED | json_FROZEN | json_EDITABLE | json_COMPACT)) != 0)return 0;
+	//the same trees as json_compact
+
+	long long count = countNodes(*doc);
+	long long capacity = 1;
+	while(capacity < count * 2)capacity <<= 1;
+
+	dedupTable table = {0};
+	table.entries = (dedupEntry*) malloc(count * sizeof(dedupEntry));
+	table.buckets = (long long*) malloc(capacity * sizeof(long long));
+	table.nodes = (json**) calloc(capacity, sizeof(json*));
+	table.nodeEntries = (long long*) malloc(capacity * sizeof(long long));
+	table.bucketMask = capacity - 1;
+	table.nodeMask = capacity - 1;
+	//the node table is kept at most half full so that probes stay short
+
+	char retVal = 0;
+	if((table.entries != NULL) && (table.buckets != NULL) && (table.nodes != NULL) && (table.nodeEntries != NULL))
+	{
+		memset(table.buckets, 0xFF, capacity * sizeof(long long));
+		dedupVisit(&table, *doc);
+		retVal = compactTree(doc, table.size, &table);
+	}
+
+	free(table.entries);
+	free(table.buckets);
+	free(table.nodes);
+	free(table.nodeEntries);
+	return retVal;
+}//merges identical values
+
+//shared tree functions
+
+json* shareTree(json* root, filecopy* source)
+{
+	if(root == NULL)return NULL;
+
+	sharedDoc* doc = (sharedDoc*) malloc(sizeof(sharedDoc));
+	if(doc == NULL)return NULL;
+
+	atomic_init(&(doc->refs), 1);
+	doc->source = source;
+	doc->block = NULL;
+	doc->root = *root;
+	doc->root.type = (root->type & ~json_SOURCED) | json_SHARED;
+	//the children don't know where their parent is, so the root can be moved freely
+
+	shareMark(&(doc->root));
+	//readers of any part of the tree rely on it not changing
+
+	return &(doc->root);
+}//makes a tree shared
+
+void shareMark(json* node)
+{
+	if((node->type & json_PACKED) != 0)return;
+	if(((node->type & json_ARRAY) != json_ARRAY) && ((node->type & json_OBJECT) != json_OBJECT))return;
+
+	json_iter iter = json_iterMake(node);
+	while(json_iterNext(&iter))
+	{
+		iter.value->type |= json_FROZEN;
+		shareMark(iter.value);
+	}
+}//marks every node under a shared root as read only
+
+void shareRetain(json* root)
+{
+	sharedDoc* doc = (sharedDoc*) (((char*) root) - offsetof(sharedDoc, root));
+	atomic_fetch_add_explicit(&(doc->refs), 1, memory_order_relaxed);
+}//adds an owner
+
+void shareRelease(json* root)
+{
+	sharedDoc* doc = (sharedDoc*) (((char*) root) - offsetof(sharedDoc, root));
+	if(atomic_fetch_sub_explicit(&(doc->refs), 1, memory_order_acq_rel) != 1)return;
+
+	if((doc->root.type & json_PACKEDBLOCK) == json_PACKEDBLOCK)compactViewsRemove(&(doc->root));
+	removeNode(&(doc->root));
+	if(doc->source != NULL)filecopyRemove(&(doc->source));
+	free(doc->block);
+	free(doc);
+}//removes an owner
+
+json* json_freeze(json* val)
+{
+	if(val == NULL)return NULL;
+	if((val->type & json_SHARED) == json_SHARED)return val;
+	if((val->type & (json_MAPPED | json_EDITABLE)) != 0)return NULL;
+
+	if((val->type & json_SOURCED) == json_SOURCED)
+	{
+		sourceDoc* doc = (sourceDoc*) (((char*) val) - offsetof(sourceDoc, root));
+		lazyConvertTree(&(doc->root));
+		//readers can't convert numbers once the tree is shared, so they are all converted now
+
+		json* retVal = shareTree(&(doc->root), doc->source);
+		if(retVal != NULL)free(doc);
+		return retVal;
+	}
+
+	if((val->type & json_COMPACT) == json_COMPACT)
+	{
+		json* retVal = shareTree(val, NULL);
+		if(retVal != NULL)((sharedDoc*) (((char*) retVal) - offsetof(sharedDoc, root)))->block = val;
+		return retVal;
+	}
+	//the old root is the start of the block, so it is kept until the block is freed
+
+	json* retVal = shareTree(val, NULL);
+	if(retVal != NULL)free(val);
+	return retVal;
+}//makes a tree read only and shared
+
+json* json_retain(json* val)
+{
+	if((val == NULL) || ((val->type & json_SHARED) != json_SHARED))return NULL;
+
+	shareRetain(val);
+	return val;
+}//adds an owner to a frozen tree
+
+void json_release(json** jsonPtr)
+{
+	json_remove(jsonPtr);
+}//removes an owner from a frozen tree
+
+//column functions
+
+char columnsMake(json_columns* out, char** fields, int fieldCount)
+{
+	out->rows = 0;
+	out->capacity = 0;
+	out->columnCount = 0;
+	out->columns = (json_column*) calloc(fieldCount, sizeof(json_column));
+	if((out->columns == NULL) && (fieldCount > 0))return 0;
+	out->columnCount = fieldCount;
+
+	for(int c = 0; c < fieldCount; c++)
+	{
+		long long len = strlen(fields[c]);
+		out->columns[c].name = (char*) malloc(sizeof(char) * (len + 1));
+		if(out->columns[c].name == NULL)return 0;
+		memcpy(out->columns[c].name, fields[c], len + 1);
+	}
+	//the columns are zeroed, so json_columnsRemove can free them even if this fails partway
+
+	return 1;
+}//makes empty columns
+
+char columnsAddRow(json_columns* out)
+{
+	if(out->rows == out->capacity)
+	{
+		long long newCapacity = (out->capacity < 64) ? 64 : out->capacity * 2;
+		//grows geometrically, like arraylistGrow
+
+		for(int c = 0; c < out->columnCount; c++)
+		{
+			json_column* column = out->columns + c;
+			void* holder = NULL;
+
+			holder = realloc(column->valid, (newCapacity + 7) / 8);
+			if(holder == NULL)return 0;
+			column->valid = (unsigned char*) holder;
+			memset(column->valid + (out->capacity + 7) / 8, 0, (newCapacity + 7) / 8 - (out->capacity + 7) / 8);
+
+			if(column->ints != NULL)
+			{
+				holder = realloc(column->ints, sizeof(long long) * newCapacity);
+				if(holder == NULL)return 0;
+				column->ints = (long long*) holder;
+			}
+			if(column->doubles != NULL)
+			{
+				holder = realloc(column->doubles, sizeof(double) * newCapacity);
+				if(holder == NULL)return 0;
+				column->doubles = (double*) holder;
+			}
+			if(column->bools != NULL)
+			{
+				holder = realloc(column->bools, sizeof(char) * newCapacity);
+				if(holder == NULL)return 0;
+				column->bools = (char*) holder;
+			}
+			if(column->offsets != NULL)
+			{
+				holder = realloc(column->offsets, sizeof(long long) * (newCapacity + 1));
+				if(holder == NULL)return 0;
+				column->offsets = (long long*) holder;
+			}
+		}
+		out->capacity = newCapacity;
+	}
+	//buffers that were already grown are kept if a later one fails, since being bigger than capacity is harmless
+
+	for(int c = 0; c < out->columnCount; c++)
+	{
+		json_column* column = out->columns + c;
+		if(column->ints != NULL)column->ints[out->rows] = 0;
+		if(column->doubles != NULL)column->doubles[out->rows] = 0;
+		if(column->bools != NULL)column->bools[out->rows] = 0;
+		if(column->offsets != NULL)column->offsets[out->rows + 1] = column->heapLen;
+	}
+	//rows without a value hold 0, or an empty string
+
+	out->rows++;
+	return 1;
+}//adds a row
+
+char columnSetType(json_columns* out, json_column* column, int type)
+{
+	void* buffer = NULL;
+	if(type == json_COLUMN_INT)
+		buffer = column->ints = (long long*) calloc(out->capacity, sizeof(long long));
+	if(type == json_COLUMN_DOUBLE)
+		buffer = column->doubles = (double*) calloc(out->capacity, sizeof(double));
+	if(type == json_COLUMN_BOOL)
+		buffer = column->bools = (char*) calloc(out->capacity, sizeof(char));
+	if(type == json_COLUMN_STRING)
+		buffer = column->offsets = (long long*) calloc(out->capacity + 1, sizeof(long long));
+	//the rows before the first value are all empty
+
+	if(buffer == NULL)return 0;
+	column->type = type;
+	return 1;
+}//types a column
+
+char columnPut(json_columns* out, json_column* column, int type, long long num, double fraction, char* str, long long strLen)
+{
+	long long row = out->rows - 1;
+
+	if((column->type == json_COLUMN_NONE) && !columnSetType(out, column, type))return 0;
+
+	if((column->type == json_COLUMN_INT) && (type == json_COLUMN_DOUBLE))
+	{
+		column->doubles = (double*) malloc(sizeof(double) * out->capacity);
+		if(column->doubles == NULL)return 0;
+		for(long long r = 0; r < out->rows; r++)column->doubles[r] = (double) column->ints[r];
+		free(column->ints);
+		column->ints = NULL;
+		column->type = json_COLUMN_DOUBLE;
+	}
+	//a double in an int column turns the whole column into doubles
+
+	if((column->type == json_COLUMN_DOUBLE) && (type == json_COLUMN_INT))
+	{
+		type = json_COLUMN_DOUBLE;
+		fraction = (double) num;
+	}
+
+	if(column->type != type)return 1;
+
+	if(type == json_COLUMN_INT)column->ints[row] = num;
+	if(type == json_COLUMN_DOUBLE)column->doubles[row] = fraction;
+	if(type == json_COLUMN_BOOL)column->bools[row] = (char) num;
+	if(type == json_COLUMN_STRING)
+	{
+		if(column->heapLen + strLen > column->heapCapacity)
+		{
+			long long newCapacity = (column->heapCapacity < 256) ? 256 : column->heapCapacity;
+			while(newCapacity < column->heapLen + strLen)newCapacity *= 2;
+			char* holder = (char*) realloc(column->heap, newCapacity);
+			if(holder == NULL)return 0;
+			column->heap = holder;
+			column->heapCapacity = newCapacity;
+		}
+		memcpy(column->heap + column->heapLen, str, strLen);
+		column->heapLen += strLen;
+		column->offsets[row + 1] = column->heapLen;
+	}
+
+	column->valid[row / 8] |= 1 << (row % 8);
+	return 1;
+}//sets a value
+
+void columnClear(json_columns* out, json_column* column)
+{
+	long long row = out->rows - 1;
+
+	if(column->ints != NULL)column->ints[row] = 0;
+	if(column->doubles != NULL)column->doubles[row] = 0;
+	if(column->bools != NULL)column->bools[row] = 0;
+	if(column->offsets != NULL)
+	{
+		column->heapLen = column->offsets[row];
+		column->offsets[row + 1] = column->heapLen;
+	}
+	//the row is the last one, so its string is at the end of the heap
+
+	column->valid[row / 8] &= ~(1 << (row % 8));
+}//clears a value
+
+long long columnsReadObject(filecopy* jsonfile, long long offset, json_columns* out, char** fields)
+{
+	char* bytes = jsonfile->bytes;
+	long long i = offset + 1;
+
+	while(1)
+	{
+		while((i < jsonfile->len) && (isWhitespace(bytes[i]) || (bytes[i] == ',')))i++;
+		if(i >= jsonfile->len)return -1;
+		if(bytes[i] == '}')return i;
+		if(bytes[i] != '"')return -1;
+
+		long long keyStart = i + 1;
+		long long keyEnd = skipValue(jsonfile, i);
+		if(keyEnd < 0)return -1;
+		long long keyLen = keyEnd - keyStart;
+
+		i = keyEnd + 1;
+		while((i < jsonfile->len) && isWhitespace(bytes[i]))i++;
+		if((i >= jsonfile->len) || (bytes[i] != ':'))return -1;
+		i++;
+		while((i < jsonfile->len) && isWhitespace(bytes[i]))i++;
+
+		long long end = skipValue(jsonfile, i);
+		if((end < 0) || (end + 1 >= jsonfile->len))return -1;
+		//the object has to go on after the value, which also keeps strtod inside the text
+
+		for(int c = 0; c < out->columnCount; c++)
+		{
+			if(
+				((long long) strlen(fields[c]) != keyLen) || 
+				(strncmp(fields[c], bytes + keyStart, keyLen) != 0)
+			) continue;
+
+			json_column* column = out->columns + c;
+			char temp = bytes[i];
+			char put = 1;
+
+			if(json_columnValid(column, out->rows - 1))columnClear(out, column);
+			//a key that shows up again in the same object replaces the value before it
+
+			if((temp == '-') || ((temp >= '0') && (temp <= '9')))
+			{
+				if(memchr(bytes + i, '.', end + 1 - i) || memchr(bytes + i, 'e', end + 1 - i) || 
+					memchr(bytes + i, 'E', end + 1 - i))
+					put = columnPut(out, column, json_COLUMN_DOUBLE, 0, strtod(bytes + i, NULL), NULL, 0);
+				else
+					put = columnPut(out, column, json_COLUMN_INT, strtoll(bytes + i, NULL, 10), 0, NULL, 0);
+			} else if(temp == '"')
+			{
+				if(memchr(bytes + i + 1, '\\', end - i - 1) == NULL)
+					put = columnPut(out, column, json_COLUMN_STRING, 0, 0, bytes + i + 1, end - i - 1);
+				else
+				{
+					json str;
+					str.type = json_STRING;
+					makeStringFromJson(json_STRING, jsonfile, i, &str);
+					if(str.type != json_INVALID)
+					{
+						size_t strLen = 0;
+						const char* decoded = json_getStringLen(&str, &strLen);
+						put = columnPut(out, column, json_COLUMN_STRING, 0, 0, (char*) decoded, strLen);
+						removeNode(&str);
+					}
+				}
+				//only strings with escapes need to be decoded
+			} else if((end - i == 3) && (strncmp(bytes + i, trueString, 4) == 0))
+				put = columnPut(out, column, json_COLUMN_BOOL, 1, 0, NULL, 0);
+			else if((end - i == 4) && (strncmp(bytes + i, falseString, 5) == 0))
+				put = columnPut(out, column, json_COLUMN_BOOL, 0, 0, NULL, 0);
+			//nulls, arrays, and objects are left out of the row
+
+			if(!put)return -1;
+		}
+
+		i = end + 1;
+	}
+}//reads an object into a row
+
+char json_toColumns(char* bytes, long long len, char** fields, int fieldCount, json_columns* out)
+{
+	if(out == NULL)return 0;
+	if(!columnsMake(out, fields, (fields == NULL) ? 0 : fieldCount))return 0;
+	if((bytes == NULL) || (len < 0))return 0;
+
+	filecopy text = {len, bytes, 0, NULL};
+	filecopy* jsonFile = &text;
+	//the text is only read, so it is used in place instead of being copied
+
+	long long i = 0;
+	while((i < len) && isWhitespace(jsonFile->bytes[i]))i++;
+	char retVal = (i < len) && (jsonFile->bytes[i] == '[');
+	i++;
+
+	while(retVal)
+	{
+		while((i < len) && (isWhitespace(jsonFile->bytes[i]) || (jsonFile->bytes[i] == ',')))i++;
+		if((i >= len) || (jsonFile->bytes[i] != '{'))
+		{
+			retVal = (i < len) && (jsonFile->bytes[i] == ']');
+			break;
+		}
+		//every record has to be an object
+
+		if(!columnsAddRow(out))
+		{
+			retVal = 0;
+			break;
+		}
+		i = columnsReadObject(jsonFile, i, out, fields);
+		if(i < 0)retVal = 0;
+		i++;
+	}
+
+	return retVal;
+}//reads json text into columns
+
+char json_treeToColumns(json* val, char** fields, int fieldCount, json_columns* out)
+{
+	if(out == NULL)return 0;
+	if(!columnsMake(out, fields, (fields == NULL) ? 0 : fieldCount))return 0;
+	if(!json_isArray(val))return 0;
+
+	size_t length = json_arrayLen64(val);
+	for(size_t r = 0; r < length; r++)
+	{
+		json* record = json_getIndex64(val, r);
+		if(!json_isObject(record))return 0;
+
+		if(!columnsAddRow(out))return 0;
+		for(int c = 0; c < out->columnCount; c++)
+		{
+			json* value = json_getMember(record, fields[c]);
+			json_column* column = out->columns + c;
+			char put = 1;
+
+			if(json_isInt(value))
+				put = columnPut(out, column, json_COLUMN_INT, json_getInt64(value), 0, NULL, 0);
+			else if(json_isDouble(value))
+				put = columnPut(out, column, json_COLUMN_DOUBLE, 0, json_getDouble(value), NULL, 0);
+			else if(json_isString(value))
+			{
+				size_t strLen = 0;
+				const char* str = json_getStringLen(value, &strLen);
+				put = columnPut(out, column, json_COLUMN_STRING, 0, 0, (char*) str, strLen);
+			}
+			else if(json_isBool(value))
+				put = columnPut(out, column, json_COLUMN_BOOL, json_getBool(value), 0, NULL, 0);
+
+			if(!put)return 0;
+		}
+	}
+
+	return 1;
+}//reads a tree into columns
+
+char json_columnValid(json_column* column, long long row)
+{
+	if((column == NULL) || (row < 0) || (column->valid == NULL))return 0;
+	return (column->valid[row / 8] >> (row % 8)) & 1;
+}//checks the validity bit of a row
+
+void json_columnsRemove(json_columns* columns)
+{
+	if((columns == NULL) || (columns->columns == NULL))return;
+
+	for(int c = 0; c < columns->columnCount; c++)
+	{
+		json_column* column = columns->columns + c;
+		free(column->name);
+		free(column->ints);
+		free(column->doubles);
+		free(column->bools);
+		free(column->offsets);
+		free(column->heap);
+		free(column->valid);
+	}
+	free(columns->columns);
+	columns->columns = NULL;
+	columns->rows = 0;
+	columns->columnCount = 0;
+}//frees columns
+
+//validation functions
+
+char validateFail(json_error* err, int code, long long offset)
+{
+	if(err != NULL)
+	{
+		err->code = code;
+		err->offset = offset;
+	}
+	return 0;
+}//records an error
+
+long long validateString(unsigned char* bytes, long long len, long long offset)
+{
+	for(long long i = offset + 1; i < len; i++)
+	{
+		unsigned char temp = bytes[i];
+		if(temp == '"')return i + 1;
+		if(temp < 0x20)return -i - 1;
+		if(temp != '\\')continue;
+
+		if(++i >= len)return -i - 1;
+		temp = bytes[i];
+		if(temp == 'u')
+		{
+			for(int h = 1; h <= 4; h++)
+			{
+				if((i + h >= len) || !isHex(bytes[i + h]))return -(i + h) - 1;
+			}
+			i += 4;
+			continue;
+		}
+		if(
+			(temp != '"') && (temp != '\\') && (temp != '/') && (temp != 'b') &&
+			(temp != 'f') && (temp != 'n') && (temp != 'r') && (temp != 't')
+		) return -i - 1;
+	}
+	return -len - 1;
+}//checks a string, returning the offset after it, or -(offset of the error) - 1
+
+long long validateNumber(unsigned char* bytes, long long len, long long offset)
+{
+	long long i = offset;
+	if((i < len) && (bytes[i] == '-'))i++;
+
+	if((i < len) && (bytes[i] == '0'))i++;
+	else if((i < len) && (bytes[i] >= '1') && (bytes[i] <= '9'))
+	{
+		while((i < len) && (bytes[i] >= '0') && (bytes[i] <= '9'))i++;
+	} else return -i - 1;
+	//the int part can't have leading zeros
+
+	if((i < len) && (bytes[i] == '.'))
+	{
+		i++;
+		if((i >= len) || (bytes[i] < '0') || (bytes[i] > '9'))return -i - 1;
+		while((i < len) && (bytes[i] >= '0') && (bytes[i] <= '9'))i++;
+	}
+
+	if((i < len) && ((bytes[i] | 0x20) == 'e'))
+	{
+		i++;
+		if((i < len) && ((bytes[i] == '+') || (bytes[i] == '-')))i++;
+		if((i >= len) || (bytes[i] < '0') || (bytes[i] > '9'))return -i - 1;
+		while((i < len) && (bytes[i] >= '0') && (bytes[i] <= '9'))i++;
+	}
+
+	return i;
+}//checks a number, returning the offset after it, or -(offset of the error) - 1
+
+char json_validate(char* text, long long len, json_error* err)
+{
+	if((text == NULL) || (len < 0))return validateFail(err, json_ERR_END, 0);
+
+	unsigned char* bytes = (unsigned char*) text;
+	char stack[json_MAXDEPTH];
+	//what each open container is, '[' or '{', kept on the stack so nothing is allocated
+
+	int depth = 0;
+	long long i = 0;
+	char expectValue = 1;
+
+	while(1)
+	{
+		while((i < len) && isWhitespace(bytes[i]))i++;
+
+		if(expectValue)
+		{
+			if(i >= len)return validateFail(err, json_ERR_END, i);
+
+			unsigned char temp = bytes[i];
+			if((temp == '[') || (temp == '{'))
+			{
+				if(depth >= json_MAXDEPTH)return validateFail(err, json_ERR_DEPTH, i);
+				stack[depth++] = temp;
+				i++;
+				while((i < len) && isWhitespace(bytes[i]))i++;
+
+				if((i < len) && (bytes[i] == ((temp == '[') ? ']' : '}')))
+				{
+					depth--;
+					i++;
+					expectValue = 0;
+					continue;
+				}
+				//empty containers close right away
+
+				if(temp == '[')continue;
+			} else if(temp == '"')
+			{
+				long long end = validateString(bytes, len, i);
+				if(end < 0)
+					return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_STRING, -end - 1);
+				i = end;
+				expectValue = 0;
+				continue;
+			} else if((temp == '-') || ((temp >= '0') && (temp <= '9')))
+			{
+				long long end = validateNumber(bytes, len, i);
+				if(end < 0)
+					return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_NUMBER, -end - 1);
+				i = end;
+				expectValue = 0;
+				continue;
+			} else if((temp == 't') || (temp == 'f') || (temp == 'n'))
+			{
+				const char* literal = (temp == 't') ? trueString : ((temp == 'f') ? falseString : nullString);
+				int literalLen = (temp == 'f') ? 5 : 4;
+				for(int l = 0; l < literalLen; l++)
+				{
+					if(i + l >= len)return validateFail(err, json_ERR_END, i + l);
+					if(bytes[i + l] != literal[l])return validateFail(err, json_ERR_LITERAL, i + l);
+				}
+				i += literalLen;
+				expectValue = 0;
+				continue;
+			} else return validateFail(err, json_ERR_SYNTAX, i);
+
+			//only an object that was just opened gets here, and it needs a key
+		} else
+		{
+			if(depth == 0)
+			{
+				if(i < len)return validateFail(err, json_ERR_TRAILING, i);
+				break;
+			}
+			if(i >= len)return validateFail(err, json_ERR_END, i);
+
+			char close = (stack[depth - 1] == '[') ? ']' : '}';
+			if(bytes[i] == close)
+			{
+				depth--;
+				i++;
+				continue;
+			}
+			if(bytes[i] != ',')return validateFail(err, json_ERR_SYNTAX, i);
+			i++;
+
+			if(close == ']')
+			{
+				expectValue = 1;
+				continue;
+			}
+			while((i < len) && isWhitespace(bytes[i]))i++;
+		}
+		//arrays go straight to their next value, objects need a key first
+
+		if(i >= len)return validateFail(err, json_ERR_END, i);
+		if(bytes[i] != '"')return validateFail(err, json_ERR_SYNTAX, i);
+
+		long long end = validateString(bytes, len, i);
+		if(end < 0)
+			return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_STRING, -end - 1);
+		i = end;
+
+		while((i < len) && isWhitespace(bytes[i]))i++;
+		if(i >= len)return validateFail(err, json_ERR_END, i);
+		if(bytes[i] != ':')return validateFail(err, json_ERR_SYNTAX, i);
+		i++;
+		expectValue = 1;
+	}
+
+	if(err != NULL)
+	{
+		err->code = json_OK;
+		err->offset = len;
+	}
+	return 1;
+}//validates json text
+
+//projection functions
+
+long long skipValue(filecopy* filec, long long offset)
+{
+	char* bytes = filec->bytes;
+	long long len = filec->len;
+
+	if(offset >= len)return -1;
+
+	if(bytes[offset] == '"')
+	{
+		for(long long i = offset + 1; i < len; i++)
+		{
+			if(bytes[i] == '\\')i++;
+			else if(bytes[i] == '"')return i;
+		}
+		return -1;
+	}
+
+	if((bytes[offset] == '[') || (bytes[offset] == '{'))
+	{
+		int depth = 0;
+		for(long long i = offset; i < len; i++)
+		{
+			char temp = bytes[i];
+			if(temp == '"')
+			{
+				i = skipValue(filec, i);
+				if(i < 0)return -1;
+				continue;
+			}
+			if((temp == '[') || (temp == '{'))depth++;
+			if(((temp == ']') || (temp == '}')) && (--depth == 0))return i;
+		}
+		return -1;
+	}
+
+	long long i = offset;
+	while(
+		(i + 1 < len) && !isWhitespace(bytes[i + 1]) && (bytes[i + 1] != ',') && 
+		(bytes[i + 1] != ']') && (bytes[i + 1] != '}')
+	) i++;
+	return i;
+	//numbers and literals end right before whitespace or a separator
+}//skips a value
+
+json* makeInvalid(json* partial)
+{
+	json_removeNodeTree(&partial);
+
+	json* retVal = (json*) malloc(sizeof(json));
+	retVal->type = json_INVALID;
+	return retVal;
+}//makes an invalid node
+
+json* makeProjectedTree(int type, filecopy* jsonfile, long long start, long long* len, char** paths, int pathCount)
+{
+	char* bytes = jsonfile->bytes;
+
+	if((type & json_ARRAY) == json_ARRAY)
+	{
+		json* retVal = json_newArray();
+		char canGetNextIndex = 1;
+		long long i = 0;
+
+		while(1)
+		{
+			i++;
+			if(start + i >= jsonfile->len)return makeInvalid(retVal);
+			if(bytes[start + i] == ']')break;
+			if(isWhitespace(bytes[start + i]))continue;
+			if(bytes[start + i] == ',')
+			{
+				canGetNextIndex = 1;
+				continue;
+			}
+			if(!canGetNextIndex)return makeInvalid(retVal);
+
+			int childType = detectJsonType(jsonfile, start + i);
+			json* child;
+			if((childType & (json_ARRAY | json_OBJECT)) != 0)
+			{
+				child = makeProjectedTree(childType, jsonfile, start + i, len, paths, pathCount);
+				i += *len;
+			} else 
+			{
+				long long end = skipValue(jsonfile, start + i);
+				if((childType == json_INVALID) || (end < 0))return makeInvalid(retVal);
+				child = makeNode(json_NULL);
+				i = end - start;
+			}
+			//elements keep their place, but only containers can hold projected members
+
+			if(json_isInvalid(child))
+			{
+				json_removeNodeTree(&child);
+				return makeInvalid(retVal);
+			}
+			json_push(retVal, child);
+			canGetNextIndex = 0;
+		}
+
+		*len = i;
+		return retVal;
+	}
+
+	if((type & json_OBJECT) != json_OBJECT)return makeNodeTree(type, jsonfile, start, len);
+	//values that aren't containers are kept whole
+
+	json* retVal = json_newObject();
+	char** subPaths = (char**) malloc(sizeof(char*) * pathCount);
+	long long i = 0;
+
+	while(1)
+	{
+		i++;
+		if(start + i >= jsonfile->len)break;
+		if(bytes[start + i] == '}')
+		{
+			*len = i;
+			free(subPaths);
+			return retVal;
+		}
+		if(isWhitespace(bytes[start + i]) || (bytes[start + i] == ','))continue;
+		if(bytes[start + i] != '"')break;
+
+		long long keyStart = start + i + 1;
+		long long keyEnd = skipValue(jsonfile, start + i);
+		if(keyEnd < 0)break;
+		i = keyEnd - start + 1;
+
+		while((start + i < jsonfile->len) && isWhitespace(bytes[start + i]))i++;
+		if(bytes[start + i] != ':')break;
+		i++;
+		while((start + i < jsonfile->len) && isWhitespace(bytes[start + i]))i++;
+		//moves to the value
+
+		char whole = 0;
+		int subCount = 0;
+		long long keyLen = keyEnd - keyStart;
+		for(int p = 0; p < pathCount; p++)
+		{
+			long long segLen = 0;
+			while((paths[p][segLen] != '.') && (paths[p][segLen] != '\0'))segLen++;
+
+			if((segLen != keyLen) || (strncmp(paths[p], bytes + keyStart, keyLen) != 0))continue;
+
+			if(paths[p][segLen] == '\0')whole = 1;
+			else subPaths[subCount++] = paths[p] + segLen + 1;
+		}
+		//keys are compared as they are written, so keys with escapes only match escaped paths
+
+		int valueType = detectJsonType(jsonfile, start + i);
+		json* value = NULL;
+		if(whole)
+		{
+			value = makeNodeTree(valueType, jsonfile, start + i, len);
+			i += *len;
+		} else if((subCount > 0) && ((valueType & (json_ARRAY | json_OBJECT)) != 0))
+		{
+			value = makeProjectedTree(valueType, jsonfile, start + i, len, subPaths, subCount);
+			i += *len;
+		} else
+		{
+			long long end = skipValue(jsonfile, start + i);
+			if((valueType == json_INVALID) || (end < 0))break;
+			i = end - start;
+			continue;
+		}
+		//members off of every path are skipped without making anything
+
+		if(json_isInvalid(value))
+		{
+			json_removeNodeTree(&value);
+			break;
+		}
+
+		json_key key;
+		if(memchr(bytes + keyStart, '\\', keyLen) != NULL)
+		{
+			json keyNode;
+			keyNode.type = json_STRING;
+			makeStringFromJson(json_STRING, jsonfile, keyStart - 1, &keyNode);
+			size_t decodedLen = 0;
+			json_getStringLen(&keyNode, &decodedLen);
+			key.string = stringTake(&keyNode);
+			key.len = decodedLen;
+		} else
+		{
+			key.string = (char*) malloc(sizeof(char) * (keyLen + 1));
+			memcpy(key.string, bytes + keyStart, keyLen);
+			key.string[keyLen] = '\0';
+			key.len = keyLen;
+		}
+		//only keys with escapes need to be decoded
+
+		arraylistPush(retVal->data.object.keys, &key);
+		arraylistPush(retVal->data.object.values, &value);
+		updateEmptyFlag(retVal);
+	}
+
+	free(subPaths);
+	return makeInvalid(retVal);
+	//anything that breaks out of the loop is malformed
+}//makes a projected node tree
+
+json* json_parseProjected(char* bytes, long long len, char** paths, int pathCount)
+{
+	if((bytes == NULL) || (len < 0) || (paths == NULL) || (pathCount < 0))return NULL;
+
+	filecopy* jsonFile = filecopyMakeFromBytes(bytes, len);
+	if(jsonFile == NULL)return NULL;
+
+	long long nodeLen = 0;
+
+	json* jsonNodeRoot = makeProjectedTree(
+		detectJsonType(jsonFile, 0), jsonFile, 0, &nodeLen, paths, pathCount
+	);
+
+	filecopyRemove(&jsonFile);
+
+	return jsonNodeRoot;
+}//parses only the members on a set of paths
+
+//lazy tree functions
+
+json* parseLazy(filecopy* jsonFile)
+{
+	sourceDoc* doc = (sourceDoc*) malloc(sizeof(sourceDoc));
+	if(doc == NULL)
+	{
+		filecopyRemove(&jsonFile);
+		return NULL;
+	}
+
+	jsonFile->flags = parse_LAZY;
+	doc->source = jsonFile;
+
+	long long len = 0;
+	json* root = makeNodeTree(detectJsonType(jsonFile, 0), jsonFile, 0, &len);
+	doc->root = *root;
+	doc->root.type |= json_SOURCED;
+	free(root);
+	//the root is moved into the doc, like in shareTree
+
+	return &(doc->root);
+}//parses a tree with lazy numbers
+
+json* json_parseLazy(char* bytes, long long len)
+{
+	if((bytes == NULL) || (len < 0))return NULL;
+
+	filecopy* jsonFile = filecopyMakeFromBytes(bytes, len);
+	if(jsonFile == NULL)return NULL;
+
+	return parseLazy(jsonFile);
+}//parses text, leaving numbers as text until they are read
+
+json* json_parseFromPathLazy(char* pathToFile)
+{
+	filecopy* jsonFile = filecopyMake(pathToFile);
+	if(jsonFile == NULL)return NULL;
+
+	return parseLazy(jsonFile);
+}//parses a file, leaving numbers as text until they are read
+
+//limited parse functions
+
+char budgetSpend(filecopy* filec, long long nodes, long long bytes, long long offset)
+{
+	parseBudget* budget = filec->budget;
+	if(budget->code != json_OK)return 0;
+
+	budget->nodes += nodes;
+	budget->memory += bytes;
+
+	if((budget->limits.maxNodes > 0) && (budget->nodes > budget->limits.maxNodes))
+		budget->code = json_ERR_NODES;
+	else if((budget->limits.maxMemory > 0) && (budget->memory > budget->limits.maxMemory))
+		budget->code = json_ERR_MEMORY;
+	else return 1;
+
+	budget->offset = offset;
+	return 0;
+}//spends part of a parse's budget
+
+json* json_parseLimited(char* bytes, long long len, const json_limits* limits, json_error* err)
+{
+	json_error ignored;
+	if(err == NULL)err = &ignored;
+	err->code = json_OK;
+	err->offset = 0;
+
+	if((bytes == NULL) || (len < 0))return NULL;
+
+	parseBudget budget = {{0}, 0, 0, 0, json_OK, 0};
+	if(limits != NULL)budget.limits = *limits;
+
+	if((budget.limits.maxBytes > 0) && (len > budget.limits.maxBytes))
+	{
+		err->code = json_ERR_BYTES;
+		err->offset = budget.limits.maxBytes;
+		return NULL;
+	}
+	//too much text is turned away before any of it is copied
+
+	filecopy* jsonFile = filecopyMakeFromBytes(bytes, len);
+	if(jsonFile == NULL)return NULL;
+	jsonFile->flags = parse_LIMITS;
+	jsonFile->budget = &budget;
+
+	long long nodeLen = 0;
+	json* retVal = makeNodeTree(detectJsonType(jsonFile, 0), jsonFile, 0, &nodeLen);
+	filecopyRemove(&jsonFile);
+
+	if(budget.code != json_OK)
+	{
+		err->code = budget.code;
+		err->offset = budget.offset;
+		json_removeNodeTree(&retVal);
+		return NULL;
+	}
+
+	if(json_isInvalid(retVal))
+	{
+		json_removeNodeTree(&retVal);
+		if(json_validate(bytes, len, err))
+		{
+			err->code = json_ERR_SYNTAX;
+			err->offset = 0;
+		}
+		return NULL;
+	}
+	//malformed text is only looked at again to say where it went wrong
+
+	return retVal;
+}//parses text within a set of limits
+
+//editable tree functions
+
+void editDocParse(editDoc* doc)
+{
+	long long len = 0;
+	json* root = makeNodeTree(detectJsonType(doc->source, 0), doc->source, 0, &len);
+
+	doc->root.node = *root;
+	doc->root.start = 0;
+	doc->root.len = doc->source->len;
+	if((root->type & json_SPANNED) == json_SPANNED)
+		doc->root.len = ((spannedNode*) root)->len;
+	free(root);
+	//the root is moved into the doc, like in shareTree
+
+	doc->root.node.type |= json_EDITABLE;
+}//parses the whole source
+
+json* json_parseEditable(char* bytes, long long len)
+{
+	if((bytes == NULL) || (len < 0))return NULL;
+
+	editDoc* doc = (editDoc*) malloc(sizeof(editDoc));
+	if(doc == NULL)return NULL;
+
+	doc->source = filecopyMakeFromBytes(bytes, len);
+	if(doc->source == NULL)
+	{
+		free(doc);
+		return NULL;
+	}
+	doc->source->flags = parse_SPANS;
+
+	editDocParse(doc);
+	return &(doc->root.node);
+}//parses a tree that can be edited
+
+int reparseChildren(json* node, long long nodeStart, filecopy* src, long long editOffset, long long oldLen, long long delta)
+{
+	if((node->type & json_SPANNED) != json_SPANNED)return 0;
+	if((node->type & json_PACKED) != 0)return 0;
+	//packed arrays only hold numbers
+
+	arraylist* children = ((node->type & json_ARRAY) == json_ARRAY) ? 
+		node->data.array : node->data.object.values;
+	json** slots = (json**) children->data;
+
+	for(long long i = 0; i < children->length; i++)
+	{
+		if((slots[i]->type & json_SPANNED) != json_SPANNED)continue;
+
+		spannedNode* child = (spannedNode*) slots[i];
+		long long childStart = nodeStart + child->start;
+
+		if(childStart > editOffset)break;
+		//children are in source order, so none of the rest can hold the edit
+
+		if((childStart == editOffset) || (editOffset + oldLen > childStart + child->len - 1))
+			continue;
+		//the edit has to be strictly between the brackets
+
+		if(!reparseNode(slots + i, childStart, src, editOffset, oldLen, delta))return -1;
+
+		((spannedNode*) node)->len += delta;
+		for(i++; i < children->length; i++)
+		{
+			if((slots[i]->type & json_SPANNED) == json_SPANNED)
+				((spannedNode*) slots[i])->start += delta;
+		}
+		//only the containers after the edit move, the ones before it keep their offsets
+
+		return 1;
+	}
+
+	return 0;
+}//reparses the child holding an edit
+
+char reparseNode(json** slot, long long nodeStart, filecopy* src, long long editOffset, long long oldLen, long long delta)
+{
+	int childResult = reparseChildren(*slot, nodeStart, src, editOffset, oldLen, delta);
+	if(childResult != 0)return childResult > 0;
+
+	spannedNode* old = (spannedNode*) *slot;
+	long long len = 0;
+	json* fresh = makeNodeTree(detectJsonType(src, nodeStart), src, nodeStart, &len);
+
+	if(
+		((fresh->type & json_SPANNED) != json_SPANNED) || 
+		(((spannedNode*) fresh)->len != old->len + delta)
+	)
+	{
+		json_removeNodeTree(&fresh);
+		return 0;
+	}
+	//the container has to end in the same place relative to everything after it
+
+	((spannedNode*) fresh)->start = old->start;
+	json_removeNodeTree(slot);
+	*slot = fresh;
+
+	return 1;
+}//reparses the container holding an edit
+
+char json_reparse(json* doc, long long editOffset, long long oldLen, char* newBytes, long long newLen)
+{
+	if((doc == NULL) || ((doc->type & json_EDITABLE) != json_EDITABLE))return 0;
+
+	editDoc* edit = (editDoc*) (((char*) doc) - offsetof(editDoc, root));
+	filecopy* src = edit->source;
+
+	if(
+		(editOffset < 0) || (oldLen < 0) || (newLen < 0) || 
+		(editOffset + oldLen > src->len) || ((newBytes == NULL) && (newLen > 0))
+	) return 0;
+
+	long long delta = newLen - oldLen;
+
+	if(delta > 0)
+	{
+		char* holder = (char*) realloc(src->bytes, src->len + delta + 1);
+		if(holder == NULL)return 0;
+		src->bytes = holder;
+	}
+
+	memmove(
+		src->bytes + editOffset + newLen,
+		src->bytes + editOffset + oldLen,
+		src->len - editOffset - oldLen
+	);
+	memcpy(src->bytes + editOffset, newBytes, newLen);
+	src->len += delta;
+	src->bytes[src->len] = 0;
+	//applies the edit to the source
+
+	if(reparseChildren(&(edit->root.node), edit->root.start, src, editOffset, oldLen, delta) > 0)
+		return 1;
+	//the root itself is never reparsed on its own, since that is the same as a full parse
+
+	removeNode(&(edit->root.node));
+	editDocParse(edit);
+	//falls back to parsing everything
+
+	return 1;
+}//reparses after an edit
+
+//slot functions
+
+json_slot* json_slotMake(json* val)
+{
+	if((val == NULL) || ((val->type & json_SHARED) != json_SHARED))return NULL;
+	//readers retain what they load, which only works for a tree made by json_freeze
+
+	json_slot* retVal = (json_slot*) malloc(sizeof(json_slot));
+	if(retVal == NULL)return NULL;
+
+	atomic_init(&(retVal->current), val);
+	atomic_init(&(retVal->epoch), 0);
+	atomic_init(&(retVal->readers[0]), 0);
+	atomic_init(&(retVal->readers[1]), 0);
+	pthread_mutex_init(&(retVal->writeLock), NULL);
+
+	return retVal;
+}//makes a slot
+
+json* json_slotAcquire(json_slot* slot)
+{
+	if(slot == NULL)return NULL;
+
+	int epoch = 0;
+	while(1)
+	{
+		int seen = atomic_load(&(slot->epoch));
+		epoch = seen & 1;
+		atomic_fetch_add(&(slot->readers[epoch]), 1);
+		if(atomic_load(&(slot->epoch)) == seen)break;
+		atomic_fetch_sub(&(slot->readers[epoch]), 1);
+	}
+	//while this reader is counted, the version it loads can't be released
+	//a swap may have drained the epoch between reading it and being counted in it, in which case the count is too late and it tries again
+
+	json* retVal = atomic_load(&(slot->current));
+	if(retVal != NULL)shareRetain(retVal);
+
+	atomic_fetch_sub(&(slot->readers[epoch]), 1);
+
+	return retVal;
+}//gets the current version
+
+char json_slotSwap(json_slot* slot, json* val)
+{
+	if((slot == NULL) || (val == NULL) || ((val->type & json_SHARED) != json_SHARED))return 0;
+	//the caller keeps its tree if it can't go in the slot
+
+	pthread_mutex_lock(&(slot->writeLock));
+
+	json* old = atomic_exchange(&(slot->current), val);
+	int epoch = atomic_fetch_add(&(slot->epoch), 1) & 1;
+	//new readers count themselves in the other epoch, so this one drains
+
+	while(atomic_load(&(slot->readers[epoch])) != 0)sched_yield();
+	//waits for readers that might have loaded the old version to retain it
+
+	pthread_mutex_unlock(&(slot->writeLock));
+
+	json_release(&old);
+	return 1;
+}//swaps in a new version
+
+void json_slotRemove(json_slot** slot)
+{
+	if((slot == NULL) || (*slot == NULL))return;
+
+	json* current = atomic_load(&((*slot)->current));
+	json_release(&current);
+	pthread_mutex_destroy(&((*slot)->writeLock));
+	free(*slot);
+	*slot = NULL;
+}//frees a slot
+
+//batch functions
+
+int filecopyReadInto(filecopy* filec, long long* capacity, char* path)
+{
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)return -1;
+
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+
+	if(fileStat.st_size + 1 > *capacity)
+	{
+		long long newCapacity = (*capacity < 4096) ? 4096 : *capacity;
+		while(newCapacity < fileStat.st_size + 1)newCapacity *= 2;
+
+		char* holder = (char*) realloc(filec->bytes, newCapacity);
+		if(holder == NULL)
+		{
+			close(fd);
+			return -1;
+		}
+		filec->bytes = holder;
+		*capacity = newCapacity;
+	}
+	//the buffer is reused between files, and only grows
+
+	long long done = 0;
+	while(done < fileStat.st_size)
+	{
+		ssize_t got = pread(fd, filec->bytes + done, fileStat.st_size - done, done);
+		if(got <= 0)break;
+		done += got;
+	}
+	close(fd);
+
+	filec->len = done;
+	filec->bytes[done] = 0;
+	return (done == fileStat.st_size) ? 0 : -1;
+}//reads a file into a reused buffer
+
+void* batchWorker(void* arg)
+{
+	batchJob* job = (batchJob*) arg;
+
+	filecopy jsonFile = {0, NULL, 0, NULL};
+	long long capacity = 0;
+
+	while(1)
+	{
+		int i = atomic_fetch_add(&(job->next), 1);
+		if(i >= job->pathCount)break;
+
+		job->out[i] = NULL;
+		if(filecopyReadInto(&jsonFile, &capacity, job->paths[i]) != 0)
+		{
+			printf("path \"%s\" is invalid\n", job->paths[i]);
+			continue;
+		}
+
+		long long len = 0;
+		int format = filecopyFormatOf((unsigned char*) jsonFile.bytes, jsonFile.len);
+		if(format == filecopy_PLAIN)job->out[i] = makeNodeTree(detectJsonType(&jsonFile, 0), &jsonFile, 0, &len);
+		else
+		{
+			filecopy* decompressed = filecopyDecompressBytes(jsonFile.bytes, jsonFile.len, format);
+			if(decompressed != NULL)
+			{
+				job->out[i] = makeNodeTree(detectJsonType(decompressed, 0), decompressed, 0, &len);
+				filecopyRemove(&decompressed);
+			}
+		}
+		//compressed files are decompressed from the bytes already read, instead of reading the file again
+
+		if(job->out[i] != NULL)atomic_fetch_add(&(job->parsed), 1);
+	}
+
+	free(jsonFile.bytes);
+	return NULL;
+}//parses files from a batch
+
+int json_parseFiles(char** paths, int pathCount, int threadCount, json** out)
+{
+	if((paths == NULL) || (out == NULL) || (pathCount <= 0))return 0;
+
+	if(threadCount <= 0)threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+	if(threadCount > pathCount)threadCount = pathCount;
+	if(threadCount < 1)threadCount = 1;
+
+	batchJob job;
+	job.paths = paths;
+	job.pathCount = pathCount;
+	job.out = out;
+	atomic_init(&(job.next), 0);
+	atomic_init(&(job.parsed), 0);
+
+	pthread_t* threads = (pthread_t*) malloc(sizeof(pthread_t) * threadCount);
+	int started = 0;
+	for(int t = 1; (threads != NULL) && (t < threadCount); t++)
+	{
+		if(pthread_create(threads + started, NULL, batchWorker, &job) == 0)started++;
+	}
+	//while one thread waits on a read, the others are parsing
+
+	batchWorker(&job);
+	//the calling thread works too
+
+	for(int t = 0; t < started; t++)pthread_join(threads[t], NULL);
+	free(threads);
+
+	return atomic_load(&(job.parsed));
+}//parses many files
+
+//path cache functions
+
+void cacheTrim(long long limit)
+{
+	cacheEntry** entryPtr = &cacheHead;
+	long long kept = 0;
+
+	while(*entryPtr != NULL)
+	{
+		cacheEntry* entry = *entryPtr;
+		if(kept + entry->bytes <= limit)
+		{
+			kept += entry->bytes;
+			entryPtr = &(entry->next);
+			continue;
+		}
+		//entries are in most recently used order, so the oldest ones are dropped first
+
+		*entryPtr = entry->next;
+		cacheBytes -= entry->bytes;
+		shareRelease(entry->root);
+		free(entry->path);
+		free(entry);
+	}
+}//shrinks the cache
+
+json* json_parseFromPathCached(char* pathToFile)
+{
+	if(pathToFile == NULL)return NULL;
+
+	struct stat fileStat;
+	if(stat(pathToFile, &fileStat) != 0)
+	{
+		printf("path \"%s\" is invalid\n", pathToFile);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&cacheLock);
+	for(cacheEntry** entryPtr = &cacheHead; *entryPtr != NULL; entryPtr = &((*entryPtr)->next))
+	{
+		cacheEntry* entry = *entryPtr;
+		if(!stringCompare(entry->path, pathToFile))continue;
+
+		if(
+			(entry->dev == fileStat.st_dev) &&
+			(entry->ino == fileStat.st_ino) &&
+			(entry->size == fileStat.st_size) &&
+			(entry->mtime.tv_sec == fileStat.st_mtim.tv_sec) &&
+			(entry->mtime.tv_nsec == fileStat.st_mtim.tv_nsec)
+		)
+		{
+			*entryPtr = entry->next;
+			entry->next = cacheHead;
+			cacheHead = entry;
+			//moves the entry to the front
+
+			shareRetain(entry->root);
+			pthread_mutex_unlock(&cacheLock);
+			return entry->root;
+		}
+		break;
+	}
+	pthread_mutex_unlock(&cacheLock);
+	//the file is parsed without the lock held so other paths aren't blocked
+
+	json* parsed = json_parseFromPath(pathToFile);
+	json* root = shareTree(parsed, NULL);
+	if(root == NULL)
+	{
+		json_remove(&parsed);
+		return NULL;
+	}
+	free(parsed);
+
+	cacheEntry* newEntry = (cacheEntry*) malloc(sizeof(cacheEntry));
+	if(newEntry == NULL)return root;
+
+	newEntry->path = strdup(pathToFile);
+	newEntry->dev = fileStat.st_dev;
+	newEntry->ino = fileStat.st_ino;
+	newEntry->size = fileStat.st_size;
+	newEntry->mtime = fileStat.st_mtim;
+	newEntry->root = root;
+	newEntry->bytes = treeSize(root, 0);
+	shareRetain(root);
+	//the cache keeps its own reference
+
+	pthread_mutex_lock(&cacheLock);
+	for(cacheEntry** entryPtr = &cacheHead; *entryPtr != NULL; entryPtr = &((*entryPtr)->next))
+	{
+		cacheEntry* entry = *entryPtr;
+		if(!stringCompare(entry->path, pathToFile))continue;
+
+		*entryPtr = entry->next;
+		cacheBytes -= entry->bytes;
+		shareRelease(entry->root);
+		free(entry->path);
+		free(entry);
+		break;
+	}
+	//replaces the stale entry, or one added by another thread in the meantime
+
+	newEntry->next = cacheHead;
+	cacheHead = newEntry;
+	cacheBytes += newEntry->bytes;
+	cacheTrim(cacheLimit);
+	pthread_mutex_unlock(&cacheLock);
+
+	return root;
+}//parses a file through the cache
+
+void json_setCacheLimit(long long maxBytes)
+{
+	pthread_mutex_lock(&cacheLock);
+	cacheLimit = (maxBytes < 0) ? 0 : maxBytes;
+	cacheTrim(cacheLimit);
+	pthread_mutex_unlock(&cacheLock);
+}//sets the cache limit
+
+void json_clearCache(void)
+{
+	pthread_mutex_lock(&cacheLock);
+	cacheTrim(0);
+	pthread_mutex_unlock(&cacheLock);
+}//empties the cache
+
+//shape functions
+
+unsigned long long shapeHash(json_key* keys, long long keyCount)
+{
+	unsigned long long retVal = 14695981039346656037ULL;
+	for(long long k = 0; k < keyCount; k++)
+	{
+		for(size_t i = 0; i < keys[k].len; i++)
+		{
+			retVal ^= (unsigned char) keys[k].string[i];
+			retVal *= 1099511628211ULL;
+		}
+		retVal ^= 0xff;
+		retVal *= 1099511628211ULL;
+		//keys are separated by a byte that can't be in utf-8, so ab,c and a,bc differ
+	}
+	return retVal;
+}//fnv-1a over the keys
+
+int shapeOf(arraylist* keys)
+{
+	if(keys->length > shapeMaxKeys)return -1;
+	//big objects are usually maps rather than records, so they would only fill the table
+
+	json_key* keySlots = (json_key*) keys->data;
+	unsigned long long hash = shapeHash(keySlots, keys->length);
+	shapeEntry** bucket = shapeTable + (hash & (shapeBuckets - 1));
+
+	for(char write = 0; write < 2; write++)
+	{
+		if(write)pthread_rwlock_wrlock(&shapeLock);
+		else pthread_rwlock_rdlock(&shapeLock);
+		//most objects have a shape that was already seen, which only needs the read lock
+
+		for(shapeEntry* entry = *bucket; entry != NULL; entry = entry->next)
+		{
+			if((entry->hash != hash) || (entry->keyCount != keys->length))continue;
+
+			long long k = 0;
+			while(
+				(k < keys->length) && (entry->keys[k].len == keySlots[k].len) &&
+				(memcmp(entry->keys[k].string, keySlots[k].string, keySlots[k].len) == 0)
+			) k++;
+
+			if(k == keys->length)
+			{
+				int id = entry->id;
+				pthread_rwlock_unlock(&shapeLock);
+				return id;
+			}
+		}
+
+		if(!write)pthread_rwlock_unlock(&shapeLock);
+		//another thread might add the shape between the unlock and the write lock, so it is searched again
+	}
+
+	int id = -1;
+	shapeEntry* entry = (shapeEntry*) malloc(sizeof(shapeEntry));
+	json_key* keyCopies = (json_key*) malloc(sizeof(json_key) * (keys->length + 1));
+
+	if((shapeCount < shapeMaxCount) && (entry != NULL) && (keyCopies != NULL))
+	{
+		for(long long k = 0; k < keys->length; k++)
+		{
+			keyCopies[k].len = keySlots[k].len;
+			keyCopies[k].string = (char*) malloc(keySlots[k].len + 1);
+			memcpy(keyCopies[k].string, keySlots[k].string, keySlots[k].len + 1);
+		}
+
+		id = ++shapeCount;
+		entry->id = id;
+		entry->hash = hash;
+		entry->keyCount = keys->length;
+		entry->keys = keyCopies;
+		entry->next = *bucket;
+		*bucket = entry;
+	} else
+	{
+		free(entry);
+		free(keyCopies);
+	}
+	//the table lives as long as the process, so it stops growing once it is full
+
+	pthread_rwlock_unlock(&shapeLock);
+	return id;
+}//finds or adds a shape
+
+//reclaim functions
+
+void* reclaimWorker(void* unused)
+{
+	(void) unused;
+
+#ifdef SCHED_IDLE
+	struct sched_param param = {0};
+	pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+	//freeing only runs when nothing else wants the cpu
+
+	pthread_mutex_lock(&reclaimLock);
+	while(1)
+	{
+		while(reclaimHead == NULL)pthread_cond_wait(&reclaimReady, &reclaimLock);
+
+		reclaimEntry* batch = reclaimHead;
+		reclaimHead = NULL;
+		pthread_mutex_unlock(&reclaimLock);
+		//the whole queue is taken at once, so callers never wait on a tree being freed
+
+		long long freed = 0;
+		while(batch != NULL)
+		{
+			reclaimEntry* next = batch->next;
+			json_remove(&(batch->root));
+			free(batch);
+			batch = next;
+			freed++;
+		}
+
+		pthread_mutex_lock(&reclaimLock);
+		reclaimPending -= freed;
+		if(reclaimPending == 0)pthread_cond_broadcast(&reclaimDone);
+	}
+
+	return NULL;
+}//frees queued trees
+
+void reclaimStart(void)
+{
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, reclaimWorker, NULL) != 0)return;
+
+	pthread_detach(thread);
+	reclaimRunning = 1;
+}//starts the reclaimer
+
+void json_removeAsync(json** jsonPtr)
+{
+	if((jsonPtr == NULL) || ((*jsonPtr) == NULL))return;
+
+	pthread_once(&reclaimOnce, reclaimStart);
+
+	reclaimEntry* entry = reclaimRunning ? (reclaimEntry*) malloc(sizeof(reclaimEntry)) : NULL;
+	if(entry == NULL)
+	{
+		json_remove(jsonPtr);
+		return;
+	}
+	//falls back to freeing on this thread
+
+	entry->root = *jsonPtr;
+
+	pthread_mutex_lock(&reclaimLock);
+	entry->next = reclaimHead;
+	reclaimHead = entry;
+	reclaimPending++;
+	pthread_cond_signal(&reclaimReady);
+	pthread_mutex_unlock(&reclaimLock);
+
+	*jsonPtr = NULL;
+}//queues a tree to be freed
+
+void json_waitForRemoves(void)
+{
+	pthread_mutex_lock(&reclaimLock);
+	while(reclaimPending > 0)pthread_cond_wait(&reclaimDone, &reclaimLock);
+	pthread_mutex_unlock(&reclaimLock);
+}//waits for the reclaimer to catch up
+
+//writer functions
+
+json_writer* writerMake(json_writeFunc write, void* context, long long capacity)
+{
+	json_writer* retVal = (json_writer*) malloc(sizeof(json_writer));
+	if(retVal == NULL)return NULL;
+
+	retVal->bytes = (char*) malloc(capacity + 1);
+	if(retVal->bytes == NULL)
+	{
+		free(retVal);
+		return NULL;
+	}
+	//one extra byte so a buffer writer's text can always be null terminated
+
+	retVal->write = write;
+	retVal->context = context;
+	retVal->len = 0;
+	retVal->capacity = capacity;
+	retVal->depth = 0;
+	retVal->needComma = 0;
+	retVal->afterKey = 0;
+	retVal->failed = 0;
+	return retVal;
+}//makes a writer
+
+json_writer* json_writerMake(json_writeFunc write, void* context)
+{
+	if(write == NULL)return NULL;
+	return writerMake(write, context, filecopyBlockSize);
+}//makes a writer that flushes to a callback
+
+long long writerFileSink(void* context, const char* bytes, long long len)
+{
+	return fwrite(bytes, sizeof(char), len, (FILE*) context);
+}//writes to a FILE ptr
+
+json_writer* json_writerMakeFile(FILE* filePtr)
+{
+	if(filePtr == NULL)return NULL;
+	return writerMake(writerFileSink, filePtr, filecopyBlockSize);
+}//makes a writer that flushes to a FILE ptr
+
+long long writerFdSink(void* context, const char* bytes, long long len)
+{
+	int fd = (int) (intptr_t) context;
+	long long done = 0;
+	while(done < len)
+	{
+		ssize_t wrote = write(fd, bytes + done, len - done);
+		if(wrote <= 0)return -1;
+		done += wrote;
+	}
+	return done;
+}//writes to a file descriptor
+
+json_writer* json_writerMakeFd(int fd)
+{
+	if(fd < 0)return NULL;
+	return writerMake(writerFdSink, (void*) (intptr_t) fd, filecopyBlockSize);
+}//makes a writer that flushes to a file descriptor
+
+json_writer* json_writerMakeBuffer(void)
+{
+	return writerMake(NULL, NULL, 256);
+}//makes a writer that keeps its text
+
+char json_writerFlush(json_writer* w)
+{
+	if((w == NULL) || w->failed)return 0;
+	if((w->write == NULL) || (w->len == 0))return 1;
+
+	if(w->write(w->context, w->bytes, w->len) != w->len)
+	{
+		w->failed = 1;
+		return 0;
+	}
+	w->len = 0;
+	return 1;
+}//flushes a writer's block
+
+char* json_writerBuffer(json_writer* w, long long* len)
+{
+	if((w == NULL) || (w->write != NULL))return NULL;
+
+	w->bytes[w->len] = '\0';
+	if(len != NULL)*len = w->len;
+	return w->bytes;
+}//gets a buffer writer's text
+
+void json_writerRemove(json_writer** w)
+{
+	if((w == NULL) || ((*w) == NULL))return;
+
+	json_writerFlush(*w);
+	free((*w)->bytes);
+	free(*w);
+	*w = NULL;
+}//frees a writer
+
+char writerPut(json_writer* w, const char* bytes, long long len)
+{
+	if(w->failed)return 0;
+
+	if(w->write == NULL)
+	{
+		if(w->len + len > w->capacity)
+		{
+			long long newCapacity = w->capacity * 2;
+			while(newCapacity < w->len + len)newCapacity *= 2;
+			//grows geometrically, like arraylistGrow
+
+			char* holder = (char*) realloc(w->bytes, newCapacity + 1);
+			if(holder == NULL)
+			{
+				w->failed = 1;
+				return 0;
+			}
+			w->bytes = holder;
+			w->capacity = newCapacity;
+		}
+		memcpy(w->bytes + w->len, bytes, len);
+		w->len += len;
+		return 1;
+	}
+
+	while(len > 0)
+	{
+		if(w->len == w->capacity)
+		{
+			if(!json_writerFlush(w))return 0;
+		}
+
+		long long room = w->capacity - w->len;
+		long long part = (len < room) ? len : room;
+		memcpy(w->bytes + w->len, bytes, part);
+		w->len += part;
+		bytes += part;
+		len -= part;
+	}
+	//sinks only ever get whole blocks, so memory use stays the same however much is written
+
+	return 1;
+}//adds bytes to a writer
+
+char writerBeforeValue(json_writer* w)
+{
+	if(w->failed)return 0;
+
+#ifndef NDEBUG
+	if((w->depth > 0) && (w->stack[w->depth - 1] == '{') && !w->afterKey)
+	{
+		w->failed = 1;
+		return 0;
+	}
+	//values in an object need a key first
+#endif
+
+	char retVal = 1;
+	if(w->afterKey)w->afterKey = 0;
+	else if(w->needComma)retVal = writerPut(w, (w->depth == 0) ? "\n" : ",", 1);
+	//values at the top level are separate documents, one per line
+
+	w->needComma = 1;
+	return retVal;
+}//writes a separator
+
+char writerQuoted(json_writer* w, const char* str, size_t len)
+{
+	if(!writerPut(w, "\"", 1))return 0;
+
+	size_t runStart = 0;
+	for(size_t i = 0; i < len; i++)
+	{
+		unsigned char temp = str[i];
+		if((temp >= 0x20) && (temp != '"') && (temp != '\\'))continue;
+
+		if(!writerPut(w, str + runStart, i - runStart))return 0;
+		runStart = i + 1;
+		//bytes that don't need escaping are copied in runs
+
+		char escape[6] = {'\\', 'u', '0', '0', '0', '0'};
+		int escapeLen = 2;
+		if(temp == '"')escape[1] = '"';
+		else if(temp == '\\')escape[1] = '\\';
+		else if(temp == '\b')escape[1] = 'b';
+		else if(temp == '\f')escape[1] = 'f';
+		else if(temp == '\n')escape[1] = 'n';
+		else if(temp == '\r')escape[1] = 'r';
+		else if(temp == '\t')escape[1] = 't';
+		else
+		{
+			escape[4] = validHex[temp >> 4];
+			escape[5] = validHex[temp & 0xf];
+			escapeLen = 6;
+		}
+		if(!writerPut(w, escape, escapeLen))return 0;
+	}
+
+	if(!writerPut(w, str + runStart, len - runStart))return 0;
+	return writerPut(w, "\"", 1);
+}//writes a string
+
+char* writerFormatInt(char* bufEnd, long long num)
+{
+	unsigned long long magnitude = (num < 0) ? -(unsigned long long) num : (unsigned long long) num;
+	char* retVal = bufEnd;
+
+	while(magnitude >= 100)
+	{
+		int pair = (magnitude % 100) * 2;
+		magnitude /= 100;
+		*--retVal = digitPairs[pair + 1];
+		*--retVal = digitPairs[pair];
+	}
+	//two digits at a time halves the number of divisions
+
+	if(magnitude >= 10)
+	{
+		*--retVal = digitPairs[magnitude * 2 + 1];
+		*--retVal = digitPairs[magnitude * 2];
+	} else *--retVal = '0' + magnitude;
+
+	if(num < 0)*--retVal = '-';
+	return retVal;
+}//formats an integer
+
+char json_writerBeginObject(json_writer* w)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+	if(w->depth >= json_MAXDEPTH)
+	{
+		w->failed = 1;
+		return 0;
+	}
+
+	w->stack[w->depth++] = '{';
+	w->needComma = 0;
+	return writerPut(w, "{", 1);
+}//opens an object
+
+char json_writerEndObject(json_writer* w)
+{
+	if((w == NULL) || w->failed)return 0;
+
+#ifndef NDEBUG
+	if((w->depth == 0) || (w->stack[w->depth - 1] != '{') || w->afterKey)
+	{
+		w->failed = 1;
+		return 0;
+	}
+	//the object has to be open, and its last key needs a value
+#endif
+
+	w->depth--;
+	w->needComma = 1;
+	return writerPut(w, "}", 1);
+}//closes an object
+
+char json_writerBeginArray(json_writer* w)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+	if(w->depth >= json_MAXDEPTH)
+	{
+		w->failed = 1;
+		return 0;
+	}
+
+	w->stack[w->depth++] = '[';
+	w->needComma = 0;
+	return writerPut(w, "[", 1);
+}//opens an array
+
+char json_writerEndArray(json_writer* w)
+{
+	if((w == NULL) || w->failed)return 0;
+
+#ifndef NDEBUG
+	if((w->depth == 0) || (w->stack[w->depth - 1] != '['))
+	{
+		w->failed = 1;
+		return 0;
+	}
+#endif
+
+	w->depth--;
+	w->needComma = 1;
+	return writerPut(w, "]", 1);
+}//closes an array
+
+char json_writerKey(json_writer* w, const char* key)
+{
+	if((w == NULL) || (key == NULL) || w->failed)return 0;
+
+#ifndef NDEBUG
+	if((w->depth == 0) || (w->stack[w->depth - 1] != '{') || w->afterKey)
+	{
+		w->failed = 1;
+		return 0;
+	}
+	//keys only go in objects, and only where a value isn't expected
+#endif
+
+	if(w->needComma && !writerPut(w, ",", 1))return 0;
+	if(!writerQuoted(w, key, strlen(key)) || !writerPut(w, ":", 1))return 0;
+
+	w->afterKey = 1;
+	return 1;
+}//writes a key
+
+char json_writerString(json_writer* w, const char* str)
+{
+	if((w == NULL) || (str == NULL))return 0;
+	if(!writerBeforeValue(w))return 0;
+	return writerQuoted(w, str, strlen(str));
+}//writes a string
+
+char json_writerInt64(json_writer* w, long long num)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+
+	char buf[24];
+	char* start = writerFormatInt(buf + sizeof(buf), num);
+	return writerPut(w, start, buf + sizeof(buf) - start);
+}//writes an integer
+
+char json_writerDouble(json_writer* w, double num)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+
+	if((num != num) || ((num - num) != 0))return writerPut(w, "null", 4);
+	//json has no nan or infinity
+
+	char buf[32];
+	for(int places = 0; (places < 16) && (num > -1e15) && (num < 1e15); places++)
+	{
+		double scaled = num * powersOf10[places];
+		if((scaled <= -9007199254740992.0) || (scaled >= 9007199254740992.0))break;
+		//past 2^53 not every integer is a double
+
+		long long whole = (long long) ((scaled < 0) ? scaled - 0.5 : scaled + 0.5);
+		if(((double) whole / powersOf10[places]) != num)continue;
+		//dividing by an exact power of 10 rounds correctly, so if this gives back num,
+		//so will reading the digits of whole with the decimal point moved
+
+		char* end = buf + sizeof(buf);
+		if(places == 0)
+		{
+			end -= 2;
+			end[0] = '.';
+			end[1] = '0';
+		}
+		//whole numbers keep a .0 so they are read back as doubles
+
+		char* start = writerFormatInt(end, (whole < 0) ? -whole : whole);
+		while(end - start <= places)*--start = '0';
+		//pads 0.05 to 005, so there is a digit before the decimal point
+
+		if(places > 0)
+		{
+			memmove(start - 1, start, (end - start) - places);
+			start--;
+			*(end - places - 1) = '.';
+		}
+		if(places == 0)end += 2;
+
+		if(signbit(num))*--start = '-';
+		return writerPut(w, start, end - start);
+		//-0.0 isn't less than 0, so its sign is read from its bits
+	}
+	//most doubles have a short decimal form, which is found without printf
+
+	int len = snprintf(buf, sizeof(buf), "%.15g", num);
+	if(strtod(buf, NULL) != num)len = snprintf(buf, sizeof(buf), "%.17g", num);
+	//15 digits is enough for most doubles and reads better, 17 is always enough to read back the same value
+
+	return writerPut(w, buf, len);
+}//writes a double
+
+char json_writerBool(json_writer* w, char boolean)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+	return boolean ? writerPut(w, "true", 4) : writerPut(w, "false", 5);
+}//writes a boolean
+
+char json_writerNull(json_writer* w)
+{
+	if((w == NULL) || !writerBeforeValue(w))return 0;
+	return writerPut(w, "null", 4);
+}//writes a null
+
+char json_writerValue(json_writer* w, json* val)
+{
+	if((w == NULL) || (val == NULL))return 0;
+
+	if(json_isObject(val))
+	{
+		if(!json_writerBeginObject(w))return 0;
+
+		json_iter iter = json_iterMake(val);
+		while(json_iterNext(&iter))
+		{
+			if(w->needComma && !writerPut(w, ",", 1))return 0;
+			if(!writerQuoted(w, iter.key, iter.keyLen) || !writerPut(w, ":", 1))return 0;
+			w->afterKey = 1;
+			if(!json_writerValue(w, iter.value))return 0;
+		}
+		//keys already have their lengths, so this skips json_writerKey's strlen
+
+		return json_writerEndObject(w);
+	}
+
+	if(json_isArray(val))
+	{
+		if(!json_writerBeginArray(w))return 0;
+
+		json_iter iter = json_iterMake(val);
+		while(json_iterNext(&iter))
+		{
+			if(!json_writerValue(w, iter.value))return 0;
+		}
+
+		return json_writerEndArray(w);
+	}
+
+	size_t textLen = 0;
+	const char* text = json_getNumberText(val, &textLen);
+	if(text != NULL)return writerBeforeValue(w) && writerPut(w, text, textLen);
+	//lazy numbers are copied exactly as they were written, without converting them
+
+	if(json_isDouble(val))return json_writerDouble(w, json_getDouble(val));
+	if(json_isInt(val))return json_writerInt64(w, json_getInt64(val));
+	if(json_isString(val))return json_writerString(w, json_getString(val));
+	if(json_isBool(val))return json_writerBool(w, json_getBool(val));
+	if(json_isNull(val))return json_writerNull(w);
+
+	w->failed = 1;
+	return 0;
+	//invalid nodes can't be written
+}//writes a tree
+
+//transcode functions
+
+//the space left in front of a messagepack container for its head, enough for a 32 bit length
+#define transcodeReserve 5
+
+//fills the space a messagepack head didn't need, it is a byte messagepack never uses
+#define transcodeFiller 0xC1
+
+int transcodeHeader(int format, int major, unsigned long long n, unsigned char* out)
+{
+	int size = (n <= 0xFF) ? 1 : ((n <= 0xFFFF) ? 2 : ((n <= 0xFFFFFFFFULL) ? 4 : 8));
+	unsigned long long bits = n;
+
+	if(format == json_TO_CBOR)
+	{
+		if(n < 24)
+		{
+			out[0] = (major << 5) | n;
+			return 1;
+		}
+		out[0] = (major << 5) | ((size == 1) ? 24 : ((size == 2) ? 25 : ((size == 4) ? 26 : 27)));
+	} else
+	{
+		static const unsigned long long fixLimits[6] = {0x80, 0x20, 0, 0x20, 0x10, 0x10};
+		static const unsigned char fixLeads[6] = {0x00, 0xFF, 0, 0xA0, 0x90, 0x80};
+		static const unsigned char leads[6][4] = {
+			{0xCC, 0xCD, 0xCE, 0xCF},
+			{0xD0, 0xD1, 0xD2, 0xD3},
+			{0, 0, 0, 0},
+			{0xD9, 0xDA, 0xDB, 0},
+			{0, 0xDC, 0xDD, 0},
+			{0, 0xDE, 0xDF, 0}
+		};
+
+		if(n < fixLimits[major])
+		{
+			out[0] = (major == 1) ? (0xFF - n) : (fixLeads[major] | n);
+			return 1;
+		}
+		//small ints, strings, arrays and maps fit in the first byte
+
+		if(major == 1)
+		{
+			size = (n < 0x80) ? 1 : ((n < 0x8000) ? 2 : ((n < 0x80000000ULL) ? 4 : 8));
+			bits = ~n;
+		}
+		//negative ints are signed, and -1 - n is ~n in two's complement
+
+		int level = (size == 1) ? 0 : ((size == 2) ? 1 : ((size == 4) ? 2 : 3));
+		while(leads[major][level] == 0)level++;
+		size = 1 << level;
+		out[0] = leads[major][level];
+		//arrays and maps have no 8 bit length
+	}
+
+	for(int i = 0; i < size; i++)
+		out[1 + i] = (unsigned char) (bits >> (8 * (size - 1 - i)));
+	//both formats are big endian
+
+	return size + 1;
+}//encodes a head
+
+void transcodePutHeader(json_writer* w, int format, int major, unsigned long long n)
+{
+	unsigned char head[9];
+	writerPut(w, (char*) head, transcodeHeader(format, major, n, head));
+}//writes a head
+
+int transcodeEscape(unsigned char* raw, long long rawLen, long long i, unsigned char* utf8, int* utf8Len)
+{
+	unsigned char escaped = raw[i];
+	*utf8Len = 1;
+
+	if(escaped == 'u')
+	{
+		int used = 5;
+		unsigned long code = 
+			(getHex(raw[i + 1]) << 12) | (getHex(raw[i + 2]) << 8) | (getHex(raw[i + 3]) << 4) | getHex(raw[i + 4]);
+
+		if((code >= 0xDC00) && (code <= 0xDFFF))return 0;
+		if((code >= 0xD800) && (code <= 0xDBFF))
+		{
+			if((i + 10 >= rawLen) || (raw[i + 5] != '\\') || (raw[i + 6] != 'u'))return 0;
+
+			unsigned long low = 
+				(getHex(raw[i + 7]) << 12) | (getHex(raw[i + 8]) << 8) | (getHex(raw[i + 9]) << 4) | getHex(raw[i + 10]);
+			if((low < 0xDC00) || (low > 0xDFFF))return 0;
+
+			code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			used = 11;
+		}
+		//characters past 0xFFFF are written as a pair of surrogates, which have to be joined back up
+
+		if(code < 0x80)utf8[0] = code;
+		else if(code < 0x800)
+		{
+			utf8[0] = 0xC0 | (code >> 6);
+			utf8[1] = 0x80 | (code & 0x3F);
+			*utf8Len = 2;
+		} else if(code < 0x10000)
+		{
+			utf8[0] = 0xE0 | (code >> 12);
+			utf8[1] = 0x80 | ((code >> 6) & 0x3F);
+			utf8[2] = 0x80 | (code & 0x3F);
+			*utf8Len = 3;
+		} else
+		{
+			utf8[0] = 0xF0 | (code >> 18);
+			utf8[1] = 0x80 | ((code >> 12) & 0x3F);
+			utf8[2] = 0x80 | ((code >> 6) & 0x3F);
+			utf8[3] = 0x80 | (code & 0x3F);
+			*utf8Len = 4;
+		}
+		return used;
+	} else if(escaped == 'b')utf8[0] = 0x08;
+	else if(escaped == 'f')utf8[0] = 0x0C;
+	else if(escaped == 'n')utf8[0] = 0x0A;
+	else if(escaped == 'r')utf8[0] = 0x0D;
+	else if(escaped == 't')utf8[0] = 0x09;
+	else utf8[0] = escaped;
+	//validateString already checked that the escape is one of these, the rest stand for themselves
+
+	return 1;
+}//decodes an escape
+
+long long transcodeString(json_writer* w, int format, unsigned char* bytes, long long len, long long offset)
+{
+	long long end = validateString(bytes, len, offset);
+	if(end < 0)return end;
+
+	unsigned char* raw = bytes + offset + 1;
+	long long rawLen = end - offset - 2;
+	if(rawLen > 0xFFFFFFFFLL)return -offset - 1;
+	//neither format is given strings this long, and messagepack can't hold them
+
+	if(memchr(raw, '\\', rawLen) == NULL)
+	{
+		transcodePutHeader(w, format, 3, rawLen);
+		writerPut(w, (char*) raw, rawLen);
+		return end;
+	}
+	//most strings have no escapes, and are copied as they are
+
+	unsigned char utf8[4];
+	int utf8Len = 0;
+	long long strLen = 0;
+	for(long long i = 0; i < rawLen; i++)
+	{
+		if(raw[i] != '\\')
+		{
+			strLen++;
+			continue;
+		}
+		int used = transcodeEscape(raw, rawLen, i + 1, utf8, &utf8Len);
+		if(used == 0)return -(offset + 1 + i + 5) - 1;
+		strLen += utf8Len;
+		i += used;
+	}
+	transcodePutHeader(w, format, 3, strLen);
+	//the escapes are decoded once to measure the string, since the head goes out before it
+
+	long long runStart = 0;
+	for(long long i = 0; i < rawLen; i++)
+	{
+		if(raw[i] != '\\')continue;
+		writerPut(w, (char*) raw + runStart, i - runStart);
+
+		i += transcodeEscape(raw, rawLen, i + 1, utf8, &utf8Len);
+		writerPut(w, (char*) utf8, utf8Len);
+		runStart = i + 1;
+	}
+	writerPut(w, (char*) raw + runStart, rawLen - runStart);
+
+	return end;
+}//writes a string
+
+long long transcodeNumber(json_writer* w, int format, unsigned char* bytes, long long len, long long offset)
+{
+	long long end = validateNumber(bytes, len, offset);
+	if(end < 0)return end;
+
+	char negative = bytes[offset] == '-';
+	char overflow = 0;
+	unsigned long long number = 0;
+	long long i = offset + negative;
+	for(; (i < end) && (bytes[i] >= '0') && (bytes[i] <= '9'); i++)
+	{
+		unsigned long long digit = bytes[i] - '0';
+		if(number > (ULLONG_MAX - digit) / 10)overflow = 1;
+		number = (number * 10) + digit;
+	}
+
+	if((i == end) && !overflow)
+	{
+		if(!negative)
+		{
+			transcodePutHeader(w, format, 0, number);
+			return end;
+		}
+		if((number > 0) && ((format == json_TO_CBOR) || (number <= 0x8000000000000000ULL)))
+		{
+			transcodePutHeader(w, format, 1, number - 1);
+			return end;
+		}
+	}
+	//ints are kept as ints as long as the format can hold them, -0 is a double so that its sign isn't lost
+
+	char text[64];
+	char* numberText = text;
+	if(end - offset >= (long long) sizeof(text))numberText = (char*) malloc(end - offset + 1);
+	if(numberText == NULL)
+	{
+		w->failed = 1;
+		return end;
+	}
+	memcpy(numberText, bytes + offset, end - offset);
+	numberText[end - offset] = '\0';
+	double fraction = strtod(numberText, NULL);
+	if(numberText != text)free(numberText);
+	//the text isn't null terminated, so the number is copied out for strtod
+
+	unsigned long long bits = 0;
+	memcpy(&bits, &fraction, sizeof(double));
+	unsigned char out[9];
+	out[0] = (format == json_TO_CBOR) ? 0xFB : 0xCB;
+	for(int b = 0; b < 8; b++)
+		out[1 + b] = (unsigned char) (bits >> (8 * (7 - b)));
+	writerPut(w, (char*) out, sizeof(out));
+
+	return end;
+}//writes a number
+
+char transcodeOpen(json_writer* w, int format, transcodeFrame* frame, int major)
+{
+	frame->major = major;
+	frame->count = 0;
+	frame->pos = w->len;
+
+	if(format == json_TO_CBOR)
+	{
+		unsigned char head = (major << 5) | 31;
+		return writerPut(w, (char*) &head, 1);
+	}
+	//cbor containers can have an indefinite length, ended by a break
+
+	static const char filler[transcodeReserve] = {
+		transcodeFiller, transcodeFiller, transcodeFiller, transcodeFiller, transcodeFiller
+	};
+	return writerPut(w, filler, transcodeReserve);
+	//messagepack needs the length first, so space is left for it
+}//starts a container
+
+char transcodeClose(json_writer* w, int format, transcodeFrame* frame)
+{
+	if(format == json_TO_CBOR)
+	{
+		unsigned char breakByte = 0xFF;
+		return writerPut(w, (char*) &breakByte, 1);
+	}
+
+	if(frame->count > 0xFFFFFFFFLL)return 0;
+
+	unsigned char head[9];
+	int headLen = transcodeHeader(format, frame->major, frame->count, head);
+	memcpy(w->bytes + frame->pos + transcodeReserve - headLen, head, headLen);
+	return 1;
+	//the head goes at the end of its space, so the filler in front of it can be squeezed out later
+}//ends a container
+
+long long transcodeSqueeze(unsigned char* out, long long len)
+{
+	static const unsigned char sizedLengths[8] = {2, 3, 5, 9, 2, 3, 5, 9};
+	//the lengths of the ints from 0xCC to 0xD3
+
+	long long pending[json_MAXDEPTH + 1];
+	int depth = 1;
+	pending[0] = 1;
+	//the values still to come in each open container, the first is the top level value
+
+	long long src = 0;
+	long long dst = 0;
+	while((depth > 0) && (src < len))
+	{
+		if(pending[depth - 1] == 0)
+		{
+			depth--;
+			continue;
+		}
+		pending[depth - 1]--;
+
+		while(out[src] == transcodeFiller)src++;
+		//only containers have filler in front of them
+
+		unsigned char lead = out[src];
+		long long size = 1;
+		long long children = 0;
+		if((lead >= 0x80) && (lead <= 0x9F))children = (lead & 0x0F) << (lead < 0x90);
+		else if((lead == 0xDC) || (lead == 0xDE))
+		{
+			size = 3;
+			children = ((out[src + 1] << 8) | out[src + 2]) << (lead == 0xDE);
+		} else if((lead == 0xDD) || (lead == 0xDF))
+		{
+			size = 5;
+			children = (((long long) out[src + 1] << 24) | (out[src + 2] << 16) | (out[src + 3] << 8) | out[src + 4]) << (lead == 0xDF);
+		} else if((lead >= 0xA0) && (lead <= 0xBF))size = 1 + (lead & 0x1F);
+		else if(lead == 0xD9)size = 2 + out[src + 1];
+		else if(lead == 0xDA)size = 3 + ((out[src + 1] << 8) | out[src + 2]);
+		else if(lead == 0xDB)size = 5 + (((long long) out[src + 1] << 24) | (out[src + 2] << 16) | (out[src + 3] << 8) | out[src + 4]);
+		else if((lead >= 0xCC) && (lead <= 0xD3))size = sizedLengths[lead - 0xCC];
+		else if(lead == 0xCB)size = 9;
+		//maps hold a key and a value for every member, everything else is a fixed size or a single byte
+
+		if(dst != src)memmove(out + dst, out + src, size);
+		dst += size;
+		src += size;
+		if(children > 0)pending[depth++] = children;
+	}
+	//one pass from the front walks every value, so the filler is found without remembering where each container was
+
+	return dst;
+}//closes up the space messagepack heads didn't need
+
+char transcodeText(unsigned char* bytes, long long len, int format, json_writer* w, json_error* err)
+{
+	transcodeFrame stack[json_MAXDEPTH];
+	//the open containers
+
+	static const unsigned char literals[2][3] = {
+		{0xC3, 0xC2, 0xC0},
+		{0xF5, 0xF4, 0xF6}
+	};
+	//true, false and null
+
+	int depth = 0;
+	long long i = 0;
+	char expectValue = 1;
+	int failCode = (w->write == NULL) ? json_ERR_MEMORY : json_ERR_WRITE;
+	//a buffer writer only fails when it can't grow, and a sink writer when write doesn't take a block
+
+	while(1)
+	{
+		if(w->failed)return validateFail(err, failCode, i);
+		while((i < len) && isWhitespace(bytes[i]))i++;
+
+		if(expectValue)
+		{
+			if(i >= len)return validateFail(err, json_ERR_END, i);
+
+			if((depth > 0) && (stack[depth - 1].major == 4))stack[depth - 1].count++;
+			//members of objects are counted at their keys
+
+			unsigned char temp = bytes[i];
+			if((temp == '[') || (temp == '{'))
+			{
+				if(depth >= json_MAXDEPTH)return validateFail(err, json_ERR_DEPTH, i);
+				transcodeFrame* top = stack + depth++;
+				if(!transcodeOpen(w, format, top, (temp == '[') ? 4 : 5))return validateFail(err, failCode, i);
+
+				i++;
+				while((i < len) && isWhitespace(bytes[i]))i++;
+
+				if((i < len) && (bytes[i] == ((temp == '[') ? ']' : '}')))
+				{
+					transcodeClose(w, format, top);
+					depth--;
+					i++;
+					expectValue = 0;
+					continue;
+				}
+				//empty containers close right away
+
+				if(temp == '[')continue;
+			} else if(temp == '"')
+			{
+				long long end = transcodeString(w, format, bytes, len, i);
+				if(end < 0)
+					return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_STRING, -end - 1);
+				i = end;
+				expectValue = 0;
+				continue;
+			} else if((temp == '-') || ((temp >= '0') && (temp <= '9')))
+			{
+				long long end = transcodeNumber(w, format, bytes, len, i);
+				if(end < 0)
+					return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_NUMBER, -end - 1);
+				i = end;
+				expectValue = 0;
+				continue;
+			} else if((temp == 't') || (temp == 'f') || (temp == 'n'))
+			{
+				int which = (temp == 't') ? 0 : ((temp == 'f') ? 1 : 2);
+				const char* literal = (which == 0) ? trueString : ((which == 1) ? falseString : nullString);
+				int literalLen = (which == 1) ? 5 : 4;
+				for(int l = 0; l < literalLen; l++)
+				{
+					if(i + l >= len)return validateFail(err, json_ERR_END, i + l);
+					if(bytes[i + l] != literal[l])return validateFail(err, json_ERR_LITERAL, i + l);
+				}
+				writerPut(w, (char*) &(literals[format == json_TO_CBOR][which]), 1);
+				i += literalLen;
+				expectValue = 0;
+				continue;
+			} else return validateFail(err, json_ERR_SYNTAX, i);
+
+			//only an object that was just opened gets here, and it needs a key
+		} else
+		{
+			if(depth == 0)
+			{
+				if(i < len)return validateFail(err, json_ERR_TRAILING, i);
+				break;
+			}
+			if(i >= len)return validateFail(err, json_ERR_END, i);
+
+			char close = (stack[depth - 1].major == 4) ? ']' : '}';
+			if(bytes[i] == close)
+			{
+				if(!transcodeClose(w, format, stack + depth - 1))return validateFail(err, json_ERR_NODES, i);
+				depth--;
+				i++;
+				continue;
+			}
+			if(bytes[i] != ',')return validateFail(err, json_ERR_SYNTAX, i);
+			i++;
+
+			if(close == ']')
+			{
+				expectValue = 1;
+				continue;
+			}
+			while((i < len) && isWhitespace(bytes[i]))i++;
+		}
+		//arrays go straight to their next value, objects need a key first
+
+		if(i >= len)return validateFail(err, json_ERR_END, i);
+		if(bytes[i] != '"')return validateFail(err, json_ERR_SYNTAX, i);
+
+		stack[depth - 1].count++;
+		long long end = transcodeString(w, format, bytes, len, i);
+		if(end < 0)
+			return validateFail(err, (-end - 1 >= len) ? json_ERR_END : json_ERR_STRING, -end - 1);
+		i = end;
+
+		while((i < len) && isWhitespace(bytes[i]))i++;
+		if(i >= len)return validateFail(err, json_ERR_END, i);
+		if(bytes[i] != ':')return validateFail(err, json_ERR_SYNTAX, i);
+		i++;
+		expectValue = 1;
+	}
+
+	if(w->failed)return validateFail(err, failCode, len);
+	return 1;
+}//translates json text
+
+char json_transcode(char* bytes, long long len, int format, json_writeFunc write, void* context, json_error* err)
+{
+	if((bytes == NULL) || (len < 0))return validateFail(err, json_ERR_END, 0);
+	if(((format != json_TO_MSGPACK) && (format != json_TO_CBOR)) || (write == NULL))
+		return validateFail(err, json_ERR_SYNTAX, 0);
+
+	json_writer* w = (format == json_TO_CBOR) ? json_writerMake(write, context) : json_writerMakeBuffer();
+	if(w == NULL)return validateFail(err, json_ERR_MEMORY, 0);
+	//cbor goes to write in blocks as it is made, messagepack is kept until its lengths are known
+
+	char retVal = transcodeText((unsigned char*) bytes, len, format, w, err);
+
+	if(retVal && (format == json_TO_MSGPACK))
+	{
+		long long squeezed = transcodeSqueeze((unsigned char*) w->bytes, w->len);
+		if(write(context, w->bytes, squeezed) != squeezed)retVal = validateFail(err, json_ERR_WRITE, len);
+		w->len = 0;
+	}
+	//json text has one top level value, so it is written once that value closes
+
+	if(retVal && !json_writerFlush(w))retVal = validateFail(err, json_ERR_WRITE, len);
+	if(!retVal)w->len = 0;
+	//the block that was being made when the text went wrong is never written
+
+	if(retVal && (err != NULL))
+	{
+		err->code = json_OK;
+		err->offset = len;
+	}
+
+	json_writerRemove(&w);
+	return retVal;
+}//translates json text to a binary format
@@ -2,34 +2,83 @@
 #define JSON_H
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 //arraylist
 typedef struct {
 	//the size of each element in the array list
-	int size;
+	long long size;
 	
 	//the length of the list
-	int length;
+	long long length;
+
+	//the number of elements that fit in data before it has to be reallocated
+	long long capacity;
 	
 	//the data in the list
 	void* data;
 } arraylist;
 
+//a key of an object, stored with its length
+typedef struct {
+	//the key, null terminated
+	char* string;
+
+	//the length of the key in bytes, not counting the null terminator
+	size_t len;
+} json_key;
+
 //an object with key value pairs
 typedef struct {
-	//an arrayList of keys
+	//an arraylist of json_keys
 	arraylist* keys;
 	
 	//an arraylist of values 
 	arraylist* values;
 } json_nodeObject;
 
+//an array of only ints or only doubles, stored without a node for each value
+typedef struct {
+	//an arraylist of the ints or doubles
+	arraylist* values;
+
+	//a json_nodeHead for each value, made the first time json_getIndex is used on the array
+	void* views;
+} json_nodePacked;
+
+//a number that hasn't been converted yet, made by json_parseLazy
+typedef struct {
+	//the value once it has been converted
+	// NOTE: this is in the same place as number and fraction, so they can be read either way
+	union {
+		long long number;
+		double fraction;
+	} value;
+
+	//the text of the number in the source of the tree
+	char* text;
+} json_nodeLazy;
+
+//a string that is too long to be kept in the node
+typedef struct {
+	//the string, null terminated
+	// NOTE: this is in the same place as string, so it can be read either way
+	char* string;
+
+	//the length of the string, not counting the null terminator
+	long long len;
+} json_nodeString;
+
 //has the data of any given json_nodeHead
 typedef union {
 	// NOTE: if the data is null, the type in the nodeHead should be json_NULL
 
 	//if the data is a number
-	int number;
+	long long number;
 	
 	//if the data is a number with a decimal
 	double fraction;
@@ -40,6 +89,13 @@ typedef union {
 	//if the data is a string
 	// NOTE: during parsing, this is used to exponents before converting them to numbers
 	char* string;
+
+	//if the data is a string, along with its length
+	json_nodeString str;
+
+	//if the data is a string of 15 bytes or less, which is kept in the node instead of being allocated
+	//the last byte is 15 minus the length, so that it is also the null terminator of a 15 byte string
+	char small[16];
 	
 	//if the data is an array
 	arraylist* array;
@@ -47,40 +103,328 @@ typedef union {
 	//if the data is an object
 	json_nodeObject object;
 
+	//if the data is an array of only ints or only doubles
+	// NOTE: values is in the same place as array, so the length can be read either way
+	json_nodePacked packed;
+
+	//if the data is a number made by json_parseLazy
+	json_nodeLazy lazy;
+
 } json_nodeBody;
 
 //has the type of data in a json node as well as a pointer to the data itself
 typedef struct {
 	int type;
+
+	//objects with the same keys in the same order share a shape, used by json_getMemberCached
+	// NOTE: 0 means the shape hasn't been worked out yet, -1 means the object has no shape,
+	// and this is unused for everything other than objects
+	int shape;
+
 	json_nodeBody data;
 } json_nodeHead;
 
 typedef json_nodeHead json;
 
+//the reasons json text can be rejected
+enum json_errorCodes {
+	//the text is valid
+	json_OK = 0,
+
+	//a character that can't appear at that point
+	json_ERR_SYNTAX,
+
+	//the text ended in the middle of a value
+	json_ERR_END,
+
+	//a malformed number, ie 01 or 1.
+	json_ERR_NUMBER,
+
+	//a bad escape sequence or an unescaped control character in a string
+	json_ERR_STRING,
+
+	//a misspelled true, false, or null
+	json_ERR_LITERAL,
+
+	//arrays and objects nested deeper than json_MAXDEPTH, or json_limits.maxDepth
+	json_ERR_DEPTH,
+
+	//something other than whitespace after the value
+	json_ERR_TRAILING,
+
+	//the text is longer than json_limits.maxBytes
+	json_ERR_BYTES,
+
+	//the text has more values than json_limits.maxNodes
+	json_ERR_NODES,
+
+	//a string or key is longer than json_limits.maxStringLen
+	json_ERR_STRINGLEN,
+
+	//the tree would use more than json_limits.maxMemory bytes
+	json_ERR_MEMORY,
+
+	//json_transcode's write function didn't take all of the output
+	json_ERR_WRITE
+};
+
+//the deepest arrays and objects can be nested when validating
+#define json_MAXDEPTH 1024
+
+//the binary formats json_transcode can write
+enum json_transcodeFormats {
+	//messagepack
+	json_TO_MSGPACK = 1,
+
+	//cbor, with arrays and maps of indefinite length so that it can be written as it is made
+	json_TO_CBOR
+};
+
+//the kinds of values a column can hold
+enum json_columnTypes {
+	//the column has no values yet
+	json_COLUMN_NONE = 0,
+
+	//the values are in ints
+	json_COLUMN_INT,
+
+	//the values are in doubles
+	json_COLUMN_DOUBLE,
+
+	//the values are in heap, from offsets[row] to offsets[row + 1]
+	json_COLUMN_STRING,
+
+	//the values are in bools
+	json_COLUMN_BOOL
+};
+
+//the values of one member across an array of objects
+typedef struct {
+	//the name of the member
+	char* name;
+
+	//one of json_columnTypes, only the buffer for this type is allocated
+	int type;
+
+	//a value for each row
+	long long* ints;
+	double* doubles;
+	char* bools;
+
+	//rows + 1 offsets into heap, the string for a row goes from offsets[row] to offsets[row + 1]
+	// NOTE: the strings in heap are not null terminated
+	long long* offsets;
+	char* heap;
+	long long heapLen;
+	long long heapCapacity;
+
+	//a bit for each row, set if the row has a value of the column's type
+	unsigned char* valid;
+} json_column;
+
+//the columns made from an array of objects
+typedef struct {
+	//the number of rows, one for each object in the array
+	long long rows;
+
+	//the number of rows the buffers have room for
+	long long capacity;
+
+	//the number of columns
+	int columnCount;
+
+	//the columns, in the order the members were asked for
+	json_column* columns;
+} json_columns;
+
+//describes why json text was rejected
+typedef struct {
+	//one of json_errorCodes
+	int code;
+
+	//the offset of the byte the error was found at
+	long long offset;
+} json_error;
+
+//limits on what json_parseLimited will parse, so that bad input can't use too much time or memory
+// NOTE: a limit of 0 means there is no limit
+typedef struct {
+	//the deepest arrays and objects can be nested
+	int maxDepth;
+
+	//the longest the text can be, in bytes
+	long long maxBytes;
+
+	//the most values the text can have, counting containers and every element and member
+	long long maxNodes;
+
+	//the longest a string or key can be, in bytes after unescaping
+	long long maxStringLen;
+
+	//the most memory the tree can use, in bytes, counting nodes, keys, and strings
+	long long maxMemory;
+} json_limits;
+
+//holds the current version of a frozen tree, so that it can be replaced while other threads read it
+typedef struct json_slot json_slot;
+
+//a member name that remembers the shape and index it was last found at,
+//so that looking it up on objects with the same keys doesn't need to scan them
+typedef struct {
+	//the name of the member, which isn't copied
+	const char* name;
+	size_t len;
+
+	//the shape of the last hit in the high 32 bits, and its index in the low 32 bits
+	// NOTE: this is updated atomically, so a handle can be shared between threads
+	unsigned long long cache;
+} json_keyHandle;
+
+//writes json text a piece at a time, without making a tree
+typedef struct json_writer json_writer;
+
+//where a json_writer sends its blocks, returns the number of bytes written, which should be len
+typedef long long (*json_writeFunc)(void* context, const char* bytes, long long len);
+
+//a cursor over the elements of an array or the members of an object
+typedef struct {
+	//the array or object being walked
+	json* container;
+
+	//the number of elements or members in container
+	size_t length;
+
+	//the index of the current element or member
+	size_t index;
+
+	//the key of the current member and its length, NULL and 0 for arrays
+	char* key;
+	size_t keyLen;
+
+	//the current element or member value
+	json* value;
+} json_iter;
+
 //parses a json file and creates a tree of nodes
 json* json_parseFromPath(char* pathToFile);
 
-//parses a json file and creates a tree of nodes
+//parses a json file from its current position to the end and creates a tree of nodes
+//returns NULL if the file can't be read
 json* json_parse(FILE* fptr);
 
+//parses many json files at once on threadCount threads, putting the tree for paths[i] in out[i]
+//files that can't be read are left as NULL in out, a threadCount of 0 or less uses one thread per cpu
+//returns the number of files that were read
+int json_parseFiles(char** paths, int pathCount, int threadCount, json** out);
+
+//parses a json file, reusing the tree from an earlier call if the file hasn't changed since
+//the tree is shared between callers, and each caller frees its reference with json_remove
+// WARNING: the tree must not be modified
+json* json_parseFromPathCached(char* pathToFile);
+
+//sets the max number of bytes of trees that json_parseFromPathCached keeps around
+void json_setCacheLimit(long long maxBytes);
+
+//drops every tree held by the json_parseFromPathCached cache
+void json_clearCache(void);
+
 //frees the data of a json pointer, and sets the ptr to NULL
 void json_remove(json** jsonPtr);
 
+//hands a json pointer to a low priority thread that frees it, and sets the ptr to NULL
+//the tree must not be used after this, but it doesn't have to be freed before the call returns
+void json_removeAsync(json** jsonPtr);
+
+//waits until every tree passed to json_removeAsync has been freed
+void json_waitForRemoves(void);
+
+//makes a tree read only so that it can be read by many threads at once without locks
+//returns the frozen tree, the old pointer should no longer be used
+// NOTE: the caller owns one reference to the frozen tree
+json* json_freeze(json* val);
+
+//adds a reference to a frozen tree, and returns the tree
+json* json_retain(json* val);
+
+//removes a reference to a frozen tree, and sets the ptr to NULL
+//the tree is freed when its last reference is removed
+void json_release(json** jsonPtr);
+
+//makes a slot holding a frozen tree, the slot takes over the caller's reference
+//returns NULL if val wasn't made by json_freeze
+json_slot* json_slotMake(json* val);
+
+//gets the current version of the tree in a slot without blocking
+//the caller owns a reference to the returned tree, and releases it with json_release
+json* json_slotAcquire(json_slot* slot);
+
+//replaces the tree in a slot with a new frozen tree, the slot takes over the caller's reference
+//the old version is freed once every reader has released it
+//returns 1 on success, and 0 if val wasn't made by json_freeze, in which case the caller still owns it
+char json_slotSwap(json_slot* slot, json* val);
+
+//frees a slot and its reference to the current tree, and sets the ptr to NULL
+void json_slotRemove(json_slot** slot);
+
 //gets the int value of a json pointer
 int json_getInt(json* val);
 
+//gets the int value of a json pointer, without cutting it down to an int
+long long json_getInt64(json* val);
+
 //gets the double value of a json pointer
 double json_getDouble(json* val);
 
 //gets the string value of a json pointer
 char* json_getString(json* val);
 
+//gets the string value of a json pointer, and puts its length in len, without having to count it
+//returns NULL if val isn't a string
+const char* json_getStringLen(json* val, size_t* len);
+
+//gets the text of a number from a tree made by json_parseLazy, and puts its length in len
+//returns NULL for anything else, including numbers that were made without json_parseLazy
+// NOTE: the text is not null terminated
+const char* json_getNumberText(json* val, size_t* len);
+
 //gets the json pointer at a specified index of a json pointer of type array
 json* json_getIndex(json* val, int index);
 
+//gets the json pointer at a specified index of a json pointer of type array, for arrays with more than INT_MAX elements
+json* json_getIndex64(json* val, size_t index);
+
 //gets the value of the specified member of a json object
 json* json_getMember(json* val, char* memberName);
 
+//gets the value of the specified member of a json object, for names that aren't null terminated
+json* json_getMemberLen(json* val, const char* memberName, size_t len);
+
+//makes a handle for repeated lookups of the same member with json_getMemberCached
+// WARNING: memberName isn't copied, so it has to outlive the handle
+json_keyHandle json_keyHandleMake(const char* memberName);
+
+//gets the value of a member of a json object like json_getMember, but when the object has the same shape
+//as the last one the handle found the member in, this is a single comparison instead of a key scan
+json* json_getMemberCached(json* val, json_keyHandle* handle);
+
+//gets the number of members in a json object, or 0 if val isn't an object
+size_t json_objectSize(json* val);
+
+//gets the key of the member at index in a json object, and sets len to its length if it isn't NULL
+//returns NULL if index is out of range
+char* json_objectKeyAt(json* val, size_t index, size_t* len);
+
+//gets the value of the member at index in a json object, or NULL if index is out of range
+json* json_objectValueAt(json* val, size_t index);
+
+//makes a cursor over an array or object, which is empty if val is neither
+//the cursor starts before the first element, so json_iterNext has to be called before reading it
+json_iter json_iterMake(json* val);
+
+//moves a cursor to the next element or member, and fills in its key and value
+//returns 1 if there was a next one, and 0 once the end is reached
+char json_iterNext(json_iter* iter);
+
 //gets the boolean value of a json ptr
 char json_getBool(json* val);
 
@@ -93,6 +437,19 @@ json* json_getObject(json* val);
 //gets the length of a json array
 int json_arrayLen(json* val);
 
+//gets the length of a json array, for arrays with more than INT_MAX elements
+//returns 0 if val isn't an array
+size_t json_arrayLen64(json* val);
+
+//gets the values of a json array that only holds doubles, without going through a node for each one
+//arrays of ints and doubles are stored as doubles, as long as every int is exact as a double
+//returns NULL if the array isn't stored that way, and sets len to the length of the array if it isn't NULL
+double* json_getDoubleArray(json* val, long long* len);
+
+//gets the values of a json array that only holds ints, without going through a node for each one
+//returns NULL if the array isn't stored that way, and sets len to the length of the array if it isn't NULL
+int64_t* json_getInt64Array(json* val, long long* len);
+
 //checks if type is int
 char json_isInt(json* val);
 
@@ -117,4 +474,179 @@ char json_isNull(json* val);
 //checks if type is invalid
 char json_isInvalid(json* val);
 
+//checks that json text is valid without making any nodes or allocating any memory
+//returns 1 if the text is valid, and 0 if not, in which case err (if not NULL) says why and where
+// NOTE: this follows the json spec strictly, so it rejects some text the parser accepts, ie [1,,2]
+char json_validate(char* bytes, long long len, json_error* err);
+
+//translates json text straight to messagepack or cbor in one pass without making any nodes, and passes it to write
+//ints stay ints when the format can hold them, and every other number, including -0, is written as a double
+//returns 1 on success, and 0 if the text is invalid or write fails, in which case err (if not NULL) says why and where
+// NOTE: cbor is passed to write in blocks as it is made, so invalid text can fail after some of it was written
+// NOTE: messagepack needs the length of a container before it, so it is only written once the value is finished
+char json_transcode(char* bytes, long long len, int format, json_writeFunc write, void* context, json_error* err);
+
+//reads the members named in fields out of json text holding an array of objects, straight into columns
+//no nodes are made, and ints that show up in a double column are converted to doubles
+//when a member shows up more than once in an object, the last one is used
+//returns 1 on success, and 0 if the text isn't an array of objects or memory couldn't be allocated
+// NOTE: out should be freed with json_columnsRemove, even if 0 was returned
+char json_toColumns(char* bytes, long long len, char** fields, int fieldCount, json_columns* out);
+
+//reads the members named in fields out of a json array of objects into columns
+//returns 1 on success, and 0 if val isn't an array of objects or memory couldn't be allocated
+// NOTE: out should be freed with json_columnsRemove, even if 0 was returned
+char json_treeToColumns(json* val, char** fields, int fieldCount, json_columns* out);
+
+//checks if a row of a column has a value
+char json_columnValid(json_column* column, long long row);
+
+//frees the buffers of a json_columns
+void json_columnsRemove(json_columns* columns);
+
+//parses json text, but only makes the members on a set of paths, every other value is skipped
+//paths are member names separated by '.', ie "user.name", and arrays on a path apply the rest of it to each element
+// NOTE: skipped values are only checked for matching brackets and quotes
+json* json_parseProjected(char* bytes, long long len, char** paths, int pathCount);
+
+//parses json text, giving up as soon as the text passes one of the limits
+//returns NULL if a limit was passed or the text is malformed, in which case err (if not NULL) says why and where
+// NOTE: limits can be NULL, which parses without limits but still fills err
+json* json_parseLimited(char* bytes, long long len, const json_limits* limits, json_error* err);
+
+//parses json text into a tree that keeps a copy of the text, numbers are only converted the first time they are read
+//the text of a number can be read with json_getNumberText without converting it
+// NOTE: the tree is freed with json_remove
+// NOTE: reading a number stores the converted value in its node, so the tree must be passed to json_freeze before more than one thread reads it
+json* json_parseLazy(char* bytes, long long len);
+
+//parses a json file like json_parseLazy
+json* json_parseFromPathLazy(char* pathToFile);
+
+//parses json text into a tree that keeps a copy of the text so that it can be edited with json_reparse
+// NOTE: the tree is freed with json_remove
+// WARNING: the tree must only be changed through json_reparse
+json* json_parseEditable(char* bytes, long long len);
+
+//replaces oldLen bytes at editOffset in the text of a tree made by json_parseEditable with newBytes,
+//and reparses only the smallest container holding the edit, or the whole text if the edit changed its structure
+//returns 1 on success, and 0 if doc is not editable or the edit is out of range
+// WARNING: nodes inside the edited container are freed, so pointers to them should not be kept
+char json_reparse(json* doc, long long editOffset, long long oldLen, char* newBytes, long long newLen);
+
+//makes a string value, the string is copied
+json* json_newString(char* str);
+
+//makes an int value
+json* json_newInt(int num);
+
+//makes a 64 bit int value
+json* json_newInt64(long long num);
+
+//makes a double value
+json* json_newDouble(double num);
+
+//makes a boolean value
+json* json_newBool(char boolean);
+
+//makes a null value
+json* json_newNull(void);
+
+//makes an empty array
+json* json_newArray(void);
+
+//makes an empty object
+json* json_newObject(void);
+
+//sets a member of a json object, replacing and freeing the old value if there is one
+//the object takes ownership of value, the key is copied
+//returns 1 on success, and 0 if val is not a modifiable object
+char json_setMember(json* val, char* memberName, json* value);
+
+//removes and frees a member of a json object
+//returns 1 if the member was removed
+char json_removeMember(json* val, char* memberName);
+
+//adds a value to the end of a json array, the array takes ownership of value
+//returns 1 on success, and 0 if val is not a modifiable array
+char json_push(json* val, json* value);
+
+//inserts a value into a json array before index, the array takes ownership of value
+//returns 1 on success, and 0 if val is not a modifiable array or index is out of range
+char json_insertAt(json* val, size_t index, json* value);
+
+//removes and frees the value at index in a json array
+//returns 1 if the value was removed
+char json_removeAt(json* val, size_t index);
+
+//makes a writer that sends its text to write in fixed size blocks, so memory use doesn't grow with the output
+json_writer* json_writerMake(json_writeFunc write, void* context);
+
+//makes a writer that writes to a FILE ptr in fixed size blocks
+json_writer* json_writerMakeFile(FILE* filePtr);
+
+//makes a writer that writes to a file descriptor in fixed size blocks
+json_writer* json_writerMakeFd(int fd);
+
+//makes a writer that keeps all of its text in a buffer, which is read with json_writerBuffer
+json_writer* json_writerMakeBuffer(void);
+
+//gets the null terminated text of a writer made with json_writerMakeBuffer, and sets len to its length if it isn't NULL
+//returns NULL for other writers
+// NOTE: the text belongs to the writer, and moves if anything else is written
+char* json_writerBuffer(json_writer* w, long long* len);
+
+//sends the bytes a writer is holding to its sink
+//returns 1 on success, and 0 if a write failed
+char json_writerFlush(json_writer* w);
+
+//flushes and frees a writer, and sets the ptr to NULL
+void json_writerRemove(json_writer** w);
+
+//the writing functions return 1 on success, and 0 if a write failed
+//unless NDEBUG is defined, they also return 0 for values that can't go where they are written,
+//ie a value in an object without a key, or an end that doesn't match its begin
+//once a writer fails, every call to it fails
+//values written outside of any container are separate documents, and are written one per line
+char json_writerBeginObject(json_writer* w);
+char json_writerEndObject(json_writer* w);
+char json_writerBeginArray(json_writer* w);
+char json_writerEndArray(json_writer* w);
+char json_writerKey(json_writer* w, const char* key);
+char json_writerString(json_writer* w, const char* str);
+char json_writerInt64(json_writer* w, long long num);
+char json_writerDouble(json_writer* w, double num);
+char json_writerBool(json_writer* w, char boolean);
+char json_writerNull(json_writer* w);
+
+//writes a whole tree as a value
+char json_writerValue(json_writer* w, json* val);
+
+//moves a whole tree into one block, in depth first order with each node's strings and children right after it
+//the pieces of the old tree are freed, and doc is set to the new root
+//packed arrays stay packed, so json_getDoubleArray and json_getInt64Array still work on them
+//freed memory isn't handed back to the system, callers who want that can call malloc_trim themselves
+//returns 1 on success, and 0 if the tree is frozen, editable, a snapshot, or already compact
+// NOTE: the tree is read only afterwards, and is still freed with json_remove
+char json_compact(json** doc);
+
+//moves a whole tree into one block like json_compact, but values that are the same are only stored once
+//every object, array, string, and number that appears more than once is shared by all of the places it appears in
+//returns 1 on success, and 0 if the tree is frozen, editable, a snapshot, or already compact
+// NOTE: the tree is read only afterwards, and is still freed with json_remove
+char json_dedup(json** doc);
+
+//writes a tree to a relocatable binary snapshot file
+//returns 0 on success and -1 on failure
+int json_saveSnapshot(json* val, char* pathToFile);
+
+//maps a snapshot file made by json_saveSnapshot into memory as a read only tree
+// NOTE: the tree can be used with all of the normal accessors, and is freed with json_remove
+// WARNING: the tree must not be modified, and only the root can be passed to json_remove
+json* json_loadSnapshot(char* pathToFile);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
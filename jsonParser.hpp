@@ -0,0 +1,259 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+#include "jsonParser.h"
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+//a header only C++17 layer over the C api
+//everything here is a thin inline call into the C accessors, nothing is allocated or copied
+namespace jsonParser {
+
+//a view of a node in a tree, it doesn't own anything and can be copied freely
+// NOTE: a Value is only valid while the Document it came from is alive
+class Value {
+public:
+	constexpr Value() noexcept : node(nullptr) {}
+	constexpr Value(json* node) noexcept : node(node) {}
+
+	//the node being viewed, or nullptr for a missing value
+	constexpr json* raw() const noexcept { return node; }
+
+	//false if the value is missing, ie a member that doesn't exist
+	constexpr explicit operator bool() const noexcept { return node != nullptr; }
+
+	bool isInt() const noexcept { return json_isInt(node); }
+	bool isDouble() const noexcept { return json_isDouble(node); }
+	bool isString() const noexcept { return json_isString(node); }
+	bool isArray() const noexcept { return json_isArray(node); }
+	bool isObject() const noexcept { return json_isObject(node); }
+	bool isBool() const noexcept { return json_isBool(node); }
+	bool isNull() const noexcept { return json_isNull(node); }
+	bool isInvalid() const noexcept { return json_isInvalid(node); }
+
+	//gets the value as T, which can be bool, any integer or floating point type,
+	//std::string_view, const char*, or Value
+	//values of the wrong type give 0, false, or an empty string, like the C accessors
+	template<typename T>
+	T get() const noexcept
+	{
+		if constexpr(std::is_same_v<T, bool>)
+			return json_getBool(node) != 0;
+		else if constexpr(std::is_integral_v<T>)
+			return static_cast<T>(json_getInt64(node));
+		else if constexpr(std::is_floating_point_v<T>)
+			return static_cast<T>(json_getDouble(node));
+		else if constexpr(std::is_same_v<T, std::string_view>)
+		{
+			std::size_t len = 0;
+			const char* str = json_getStringLen(node, &len);
+			return (str == nullptr) ? std::string_view() : std::string_view(str, len);
+		} else if constexpr(std::is_same_v<T, const char*>)
+			return json_getString(node);
+		else if constexpr(std::is_same_v<T, Value>)
+			return *this;
+		else
+			static_assert(sizeof(T) == 0, "jsonParser::Value::get can't make this type");
+	}
+
+	//gets a member of an object, or a missing value
+	Value operator[](std::string_view key) const noexcept
+	{
+		return json_getMemberLen(node, key.data(), key.size());
+	}
+
+	//gets an element of an array, or a missing value
+	// NOTE: the index is not bounds checked, like json_getIndex
+	Value operator[](std::size_t index) const noexcept
+	{
+		return json_getIndex64(node, index);
+	}
+
+	//avoids ambiguity between the two operator[] for literal indexes like v[0]
+	Value operator[](int index) const noexcept
+	{
+		return json_getIndex(node, index);
+	}
+
+	//the number of elements in an array or members in an object, or 0 for anything else
+	std::size_t size() const noexcept
+	{
+		return isObject() ? json_objectSize(node) : json_arrayLen64(node);
+	}
+
+	//iterates over the elements of an array
+	// NOTE: elements are returned as Values rather than references, the same way std::vector<bool> returns proxies
+	class ArrayIterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Value;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = Value;
+
+		constexpr ArrayIterator() noexcept : array(nullptr), index(0) {}
+		constexpr ArrayIterator(json* array, std::size_t index) noexcept : array(array), index(index) {}
+
+		Value operator*() const noexcept { return json_getIndex64(array, index); }
+		Value operator[](difference_type n) const noexcept { return json_getIndex64(array, index + n); }
+
+		ArrayIterator& operator++() noexcept { index++; return *this; }
+		ArrayIterator operator++(int) noexcept { ArrayIterator temp = *this; index++; return temp; }
+		ArrayIterator& operator--() noexcept { index--; return *this; }
+		ArrayIterator operator--(int) noexcept { ArrayIterator temp = *this; index--; return temp; }
+
+		ArrayIterator& operator+=(difference_type n) noexcept { index += n; return *this; }
+		ArrayIterator& operator-=(difference_type n) noexcept { index -= n; return *this; }
+		ArrayIterator operator+(difference_type n) const noexcept { return ArrayIterator(array, index + n); }
+		ArrayIterator operator-(difference_type n) const noexcept { return ArrayIterator(array, index - n); }
+		friend ArrayIterator operator+(difference_type n, const ArrayIterator& it) noexcept { return it + n; }
+		difference_type operator-(const ArrayIterator& other) const noexcept
+		{
+			return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+		}
+
+		bool operator==(const ArrayIterator& other) const noexcept { return index == other.index; }
+		bool operator!=(const ArrayIterator& other) const noexcept { return index != other.index; }
+		bool operator<(const ArrayIterator& other) const noexcept { return index < other.index; }
+		bool operator>(const ArrayIterator& other) const noexcept { return index > other.index; }
+		bool operator<=(const ArrayIterator& other) const noexcept { return index <= other.index; }
+		bool operator>=(const ArrayIterator& other) const noexcept { return index >= other.index; }
+
+	private:
+		json* array;
+		std::size_t index;
+	};
+
+	//iterates over the members of an object in the order they were written
+	class MemberIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::pair<std::string_view, Value>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		constexpr MemberIterator() noexcept : object(nullptr), index(0) {}
+		constexpr MemberIterator(json* object, std::size_t index) noexcept : object(object), index(index) {}
+
+		value_type operator*() const noexcept
+		{
+			std::size_t len = 0;
+			const char* key = json_objectKeyAt(object, index, &len);
+			return value_type(std::string_view(key, len), json_objectValueAt(object, index));
+		}
+		MemberIterator& operator++() noexcept { index++; return *this; }
+		MemberIterator operator++(int) noexcept { MemberIterator temp = *this; index++; return temp; }
+		bool operator==(const MemberIterator& other) const noexcept { return index == other.index; }
+		bool operator!=(const MemberIterator& other) const noexcept { return index != other.index; }
+
+	private:
+		json* object;
+		std::size_t index;
+	};
+
+	//a range over the members of an object, for range-for
+	class Members {
+	public:
+		constexpr Members(json* object) noexcept : object(object) {}
+		MemberIterator begin() const noexcept { return MemberIterator(object, 0); }
+		MemberIterator end() const noexcept { return MemberIterator(object, json_objectSize(object)); }
+		std::size_t size() const noexcept { return json_objectSize(object); }
+
+	private:
+		json* object;
+	};
+
+	//the elements of an array, so that a Value can be used in range-for directly
+	//anything that isn't an array is empty
+	ArrayIterator begin() const noexcept { return ArrayIterator(node, 0); }
+	ArrayIterator end() const noexcept { return ArrayIterator(node, json_arrayLen64(node)); }
+
+	//the members of an object, as (key, value) pairs
+	//anything that isn't an object is empty
+	Members members() const noexcept { return Members(node); }
+
+private:
+	json* node;
+};
+
+static_assert(std::is_trivially_copyable_v<Value>, "Value has to stay a plain pointer");
+
+//owns the root of a tree, and frees it with json_remove
+//it can be moved but not copied, since there is only one owner
+class Document {
+public:
+	constexpr Document() noexcept : root(nullptr) {}
+
+	//takes ownership of a root made by the C api
+	explicit constexpr Document(json* root) noexcept : root(root) {}
+
+	Document(const Document&) = delete;
+	Document& operator=(const Document&) = delete;
+
+	Document(Document&& other) noexcept : root(std::exchange(other.root, nullptr)) {}
+	Document& operator=(Document&& other) noexcept
+	{
+		if(this != &other)
+		{
+			json_remove(&root);
+			root = std::exchange(other.root, nullptr);
+		}
+		return *this;
+	}
+
+	~Document() { json_remove(&root); }
+
+	//parses a json file, the document is empty if the file can't be read
+	static Document fromPath(const char* pathToFile)
+	{
+		return Document(json_parseFromPath(const_cast<char*>(pathToFile)));
+	}
+
+	//parses a json file from a FILE ptr
+	static Document fromFile(std::FILE* filePtr)
+	{
+		return Document(json_parse(filePtr));
+	}
+
+	//maps a snapshot made by json_saveSnapshot
+	static Document fromSnapshot(const char* pathToFile)
+	{
+		return Document(json_loadSnapshot(const_cast<char*>(pathToFile)));
+	}
+
+	//a view of the root
+	Value value() const noexcept { return root; }
+
+	//shortcuts to the root's accessors
+	Value operator[](std::string_view key) const noexcept { return value()[key]; }
+	Value operator[](std::size_t index) const noexcept { return value()[index]; }
+	Value operator[](int index) const noexcept { return value()[index]; }
+	Value::ArrayIterator begin() const noexcept { return value().begin(); }
+	Value::ArrayIterator end() const noexcept { return value().end(); }
+
+	//moves the tree into one block with json_compact, after which it is read only
+	bool compact() noexcept { return json_compact(&root) != 0; }
+
+	//moves the tree into one block with json_dedup, sharing values that are the same
+	bool dedup() noexcept { return json_dedup(&root) != 0; }
+
+	//false if nothing was parsed
+	explicit operator bool() const noexcept { return root != nullptr; }
+
+	//the root, still owned by the document
+	json* raw() const noexcept { return root; }
+
+	//gives up ownership of the root, the caller has to free it with json_remove
+	json* release() noexcept { return std::exchange(root, nullptr); }
+
+private:
+	json* root;
+};
+
+}
+
+#endif
@@ -0,0 +1,827 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../jsonParser.h"
+
+//prints the values at a set of json pointers in a json file without parsing it into a tree
+//only the path to the current value is kept, so memory use doesn't depend on the size of the file
+//usage: jsonq [-p] [-f file] pointer...
+//pointers are like "/users/0/name", a segment of "*" matches any key or index, and "" matches the whole value
+//files with more than one value, like one value per line, are matched one value at a time
+//-p prints the path of each match before it, separated by a tab
+//a match inside another match is held until the outer one has been printed, so only overlapping queries use memory for values
+//exits with 2 if the input isn't balanced json, is nested deeper than json_MAXDEPTH, or ends in the middle of a value
+
+//the size of each block the file is read in
+#define jsonq_BLOCKSIZE (1 << 20)
+
+//the number of blocks that can be read ahead of the scanner
+#define jsonq_BLOCKCOUNT 4
+
+//the longest key that is kept, longer keys are only matched by "*"
+#define jsonq_KEYMAX 256
+
+//the number of bytes of a number, true, false, or null that are kept to check it
+#define jsonq_SCALARMAX 32
+
+//what the scanner is in the middle of
+enum scanStates {
+
+	//between values
+	scan_VALUE,
+
+	//a key of an object
+	scan_KEY,
+
+	//a string value
+	scan_STRING,
+
+	//a number, true, false, or null
+	scan_SCALAR,
+
+	//an array or object that is being printed or skipped without looking at its members
+	scan_SKIP
+};
+
+//what pathMatch found, as flags
+enum matchFlags {
+
+	//a query might match something inside the current value
+	match_INSIDE = 1,
+
+	//a query matches the current value
+	match_EXACT = 2
+};
+
+//the bytes that scan_SKIP has to stop at, everything else is stepped over
+const char skipClass[256] = {
+	['"'] = 1, ['\\'] = 1, ['{'] = 1, ['}'] = 1, ['['] = 1, [']'] = 1
+};
+
+//one segment of a pointer
+typedef struct {
+	//the segment with its ~0 and ~1 escapes undone
+	char* key;
+	size_t keyLen;
+
+	//the segment as an index, or -1 if it isn't a number
+	long long index;
+
+	//the segment is "*"
+	char any;
+} segment;
+
+//a pointer to match
+typedef struct {
+	segment* segs;
+	int segCount;
+} query;
+
+//an array or object the scanner is inside of
+typedef struct {
+	//'{' or '['
+	char kind;
+
+	//the next string in an object is a key
+	char expectKey;
+
+	//the index of the current element of an array
+	long long index;
+
+	//the key of the current member of an object
+	char key[jsonq_KEYMAX];
+	size_t keyLen;
+	char keyTooLong;
+} frame;
+
+//a growable run of bytes
+typedef struct {
+	char* bytes;
+	long long len;
+	long long capacity;
+} text;
+
+//a match that hasn't ended yet
+typedef struct {
+	//the depth the scanner gets back to when the match ends
+	int depth;
+
+	//the held match it is, or -1 for the match being printed
+	long long held;
+} openMatch;
+
+//a match inside the match being printed
+typedef struct {
+	//where its path and its value are in paths and values
+	long long pathStart;
+	long long pathEnd;
+	long long start;
+	long long end;
+} heldMatch;
+
+typedef struct {
+	query* queries;
+	int queryCount;
+
+	frame stack[json_MAXDEPTH];
+	int depth;
+
+	//one of scanStates
+	int state;
+
+	//for scan_SKIP, the number of brackets that are still open
+	long long nest;
+
+	//for scan_SKIP, a bit for each bracket that is still open, set for '{' and clear for '['
+	unsigned char nestKinds[json_MAXDEPTH / 8 + 1];
+
+	//for scan_SKIP, scan_STRING and scan_KEY
+	char inString;
+	char escaped;
+
+	//for scan_SCALAR, the start and last byte of the scalar
+	char scalar[jsonq_SCALARMAX];
+	long long scalarLen;
+	char scalarLast;
+
+	//a match is being printed, from emitFrom in the current block
+	char emitting;
+	long long emitFrom;
+
+	//the matches that haven't ended yet, innermost last
+	openMatch open[json_MAXDEPTH + 1];
+	int openCount;
+
+	//matches inside the one being printed, with the text they are copied out of
+	heldMatch* held;
+	long long heldCount;
+	long long heldCapacity;
+	int heldOpen;
+	text values;
+	text paths;
+
+	//the number of bytes in the blocks before the current one
+	long long offset;
+
+	char printPaths;
+	char failed;
+	long long matches;
+	FILE* out;
+} scanner;
+
+//blocks passed from the reader thread to the scanner
+typedef struct {
+	int fd;
+	char* blocks[jsonq_BLOCKCOUNT];
+	long long lens[jsonq_BLOCKCOUNT];
+
+	//the number of blocks read but not scanned yet
+	int filled;
+	int readIndex;
+	int writeIndex;
+
+	//the reader hit the end of the file, or an error
+	char done;
+	char failed;
+
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+} blockQueue;
+
+//splits a json pointer into segments
+//returns 0 if the pointer doesn't start with '/' and isn't empty
+char queryMake(query* q, char* pointer);
+
+//reads the file into the queue's blocks until it ends
+//returns NULL, so that it can be used with pthread_create
+void* readerWorker(void* arg);
+
+//scans a block, printing matches as they end
+void scanBlock(scanner* s, const char* bytes, long long len);
+
+//checks that the input didn't end in the middle of a value, and ends a scalar at the very end of it
+void scanFinish(scanner* s);
+
+//checks if a char ends a number, true, false, or null
+char isDelimiter(char c);
+
+//decides what to do with a value that starts with c, and pushes a frame if it is a container that might hold a match
+//returns the scanState to go on in
+int valueStart(scanner* s, char c);
+
+//checks the path to the current value against every query
+//returns the matchFlags for it, or 0 if nothing can match it or anything inside it
+int pathMatch(scanner* s);
+
+//adds the path to the current value as a json pointer, and a tab, to a text
+void pathText(scanner* s, text* into);
+
+//adds bytes to a text
+//returns 0 if it couldn't grow
+char textPut(text* t, const char* bytes, long long len);
+
+//starts a match at the current value
+void matchOpen(scanner* s);
+
+//ends the innermost match, printing it and the matches held inside it if it is the outer one
+void matchClose(scanner* s);
+
+//writes the match being printed up to a byte of the block, copying it for the held matches that are open
+void emitUpTo(scanner* s, const char* bytes, long long to);
+
+//ends the innermost match if the value that ended at a byte of the block was it
+void valueEnd(scanner* s, const char* bytes, long long end);
+
+//checks that a number, true, false, or null is one
+char scalarValid(scanner* s);
+
+int main(int argc, char** argv)
+{
+	scanner s;
+	memset(&s, 0, sizeof(scanner));
+	s.out = stdout;
+	s.queries = (query*) malloc(sizeof(query) * argc);
+
+	char* path = NULL;
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-p") == 0)
+		{
+			s.printPaths = 1;
+			continue;
+		}
+		if((strcmp(argv[i], "-f") == 0) && (i + 1 < argc))
+		{
+			path = argv[++i];
+			continue;
+		}
+		if(!queryMake(s.queries + s.queryCount, argv[i]))
+		{
+			fprintf(stderr, "jsonq: \"%s\" is not a json pointer\n", argv[i]);
+			return 2;
+		}
+		s.queryCount++;
+	}
+
+	if(s.queryCount == 0)
+	{
+		fprintf(stderr, "usage: jsonq [-p] [-f file] pointer...\n");
+		return 2;
+	}
+
+	blockQueue queue;
+	memset(&queue, 0, sizeof(blockQueue));
+	queue.fd = (path == NULL) ? STDIN_FILENO : open(path, O_RDONLY);
+	if(queue.fd < 0)
+	{
+		fprintf(stderr, "jsonq: can't open \"%s\"\n", path);
+		return 2;
+	}
+
+	for(int i = 0; i < jsonq_BLOCKCOUNT; i++)
+	{
+		queue.blocks[i] = (char*) malloc(jsonq_BLOCKSIZE);
+		if(queue.blocks[i] == NULL)return 2;
+	}
+	pthread_mutex_init(&queue.lock, NULL);
+	pthread_cond_init(&queue.changed, NULL);
+
+	static char outBuffer[1 << 16];
+	setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+
+	pthread_t reader;
+	if(pthread_create(&reader, NULL, readerWorker, &queue) != 0)return 2;
+	//the next blocks are read while this one is scanned
+
+	pthread_mutex_lock(&queue.lock);
+	while(!s.failed)
+	{
+		while((queue.filled == 0) && !queue.done)pthread_cond_wait(&queue.changed, &queue.lock);
+		if(queue.filled == 0)break;
+		pthread_mutex_unlock(&queue.lock);
+
+		scanBlock(&s, queue.blocks[queue.readIndex], queue.lens[queue.readIndex]);
+		queue.readIndex = (queue.readIndex + 1) % jsonq_BLOCKCOUNT;
+
+		pthread_mutex_lock(&queue.lock);
+		queue.filled--;
+		pthread_cond_signal(&queue.changed);
+	}
+	queue.done = 1;
+	pthread_cond_signal(&queue.changed);
+	pthread_mutex_unlock(&queue.lock);
+	//stops the reader if the scanner gave up first
+
+	pthread_join(reader, NULL);
+	if(!queue.failed)scanFinish(&s);
+	if(s.emitting)fputc('\n', stdout);
+	//a match cut off by an error still ends its line
+	fflush(stdout);
+
+	if(queue.failed || s.failed)return 2;
+	return (s.matches > 0) ? 0 : 1;
+	//exits like grep, 0 if something matched, 1 if nothing did, and 2 on errors
+}
+
+char queryMake(query* q, char* pointer)
+{
+	q->segCount = 0;
+	q->segs = NULL;
+	if(pointer[0] == '\0')return 1;
+	if(pointer[0] != '/')return 0;
+
+	for(char* c = pointer; *c != '\0'; c++)q->segCount += *c == '/';
+	q->segs = (segment*) malloc(sizeof(segment) * q->segCount);
+
+	char* start = pointer + 1;
+	for(int i = 0; i < q->segCount; i++)
+	{
+		char* end = strchr(start, '/');
+		if(end == NULL)end = start + strlen(start);
+
+		segment* seg = q->segs + i;
+		seg->key = (char*) malloc(end - start + 1);
+		seg->keyLen = 0;
+		for(char* c = start; c < end; c++)
+		{
+			if((c[0] == '~') && (c + 1 < end) && ((c[1] == '0') || (c[1] == '1')))
+			{
+				seg->key[seg->keyLen++] = (c[1] == '0') ? '~' : '/';
+				c++;
+				continue;
+			}
+			seg->key[seg->keyLen++] = *c;
+		}
+		seg->key[seg->keyLen] = '\0';
+
+		seg->any = (end - start == 1) && (start[0] == '*');
+
+		seg->index = (seg->keyLen > 0) ? 0 : -1;
+		for(size_t j = 0; j < seg->keyLen; j++)
+		{
+			if((seg->key[j] < '0') || (seg->key[j] > '9'))
+			{
+				seg->index = -1;
+				break;
+			}
+			seg->index = (seg->index * 10) + (seg->key[j] - '0');
+		}
+
+		start = end + 1;
+	}
+
+	return 1;
+}//splits a json pointer
+
+void* readerWorker(void* arg)
+{
+	blockQueue* queue = (blockQueue*) arg;
+
+	while(1)
+	{
+		pthread_mutex_lock(&queue->lock);
+		while((queue->filled == jsonq_BLOCKCOUNT) && !queue->done)
+			pthread_cond_wait(&queue->changed, &queue->lock);
+		char stop = queue->done;
+		pthread_mutex_unlock(&queue->lock);
+		if(stop)return NULL;
+
+		char* block = queue->blocks[queue->writeIndex];
+		long long len = 0;
+		while(len < jsonq_BLOCKSIZE)
+		{
+			ssize_t got = read(queue->fd, block + len, jsonq_BLOCKSIZE - len);
+			if(got <= 0)
+			{
+				if(got < 0)queue->failed = 1;
+				break;
+			}
+			len += got;
+		}
+		//fills the whole block, pipes give back less than was asked for
+
+		pthread_mutex_lock(&queue->lock);
+		if(len > 0)
+		{
+			queue->lens[queue->writeIndex] = len;
+			queue->writeIndex = (queue->writeIndex + 1) % jsonq_BLOCKCOUNT;
+			queue->filled++;
+		}
+		if(len < jsonq_BLOCKSIZE)queue->done = 1;
+		pthread_cond_signal(&queue->changed);
+		pthread_mutex_unlock(&queue->lock);
+
+		if(len < jsonq_BLOCKSIZE)return NULL;
+	}
+}//reads blocks ahead of the scanner
+
+void scanBlock(scanner* s, const char* bytes, long long len)
+{
+	s->emitFrom = 0;
+	//values that are being printed are written out when they end, or when the block does
+
+	for(long long i = 0; (i < len) && !s->failed; i++)
+	{
+		char c = bytes[i];
+		long long end = i + 1;
+		//where the current value ends, if it ends at this byte
+
+		if(s->state == scan_SKIP)
+		{
+			for(; i < len; i++)
+			{
+				c = bytes[i];
+				if(!skipClass[(unsigned char) c] && !s->escaped)continue;
+				if(s->inString)
+				{
+					if(s->escaped)s->escaped = 0;
+					else if(c == '\\')s->escaped = 1;
+					else if(c == '"')s->inString = 0;
+					continue;
+				}
+				if(c == '"')s->inString = 1;
+				else if((c == '{') || (c == '['))
+				{
+					if(s->depth + s->nest == json_MAXDEPTH)
+					{
+						fprintf(stderr, "jsonq: nested deeper than %d\n", json_MAXDEPTH);
+						s->failed = 1;
+						break;
+					}
+					if(c == '{')s->nestKinds[s->nest / 8] |= 1 << (s->nest % 8);
+					else s->nestKinds[s->nest / 8] &= ~(1 << (s->nest % 8));
+					s->nest++;
+				} else
+				{
+					s->nest--;
+					if(((s->nestKinds[s->nest / 8] >> (s->nest % 8)) & 1) != (c == '}'))
+					{
+						fprintf(stderr, "jsonq: unbalanced '%c' at byte %lld\n", c, s->offset + i);
+						s->failed = 1;
+						break;
+					}
+					if(s->nest == 0)break;
+				}
+			}
+			//only quotes, escapes and brackets matter here, so this is the loop most of a big file goes through
+			//closers are checked against their openers, so skipped input is held to the same rules as the rest
+
+			if((i == len) || s->failed)break;
+			end = i + 1;
+		} else if(s->state == scan_STRING)
+		{
+			for(; i < len; i++)
+			{
+				c = bytes[i];
+				if(s->escaped)s->escaped = 0;
+				else if(c == '\\')s->escaped = 1;
+				else if(c == '"')break;
+			}
+			if(i == len)break;
+			end = i + 1;
+		} else if(s->state == scan_SCALAR)
+		{
+			for(; (i < len) && !isDelimiter(bytes[i]); i++)
+			{
+				if(s->scalarLen < jsonq_SCALARMAX)s->scalar[s->scalarLen] = bytes[i];
+				s->scalarLen++;
+				s->scalarLast = bytes[i];
+			}
+			if(i == len)break;
+
+			if(!scalarValid(s))
+			{
+				fprintf(stderr, "jsonq: invalid value before byte %lld\n", s->offset + i);
+				s->failed = 1;
+				break;
+			}
+
+			end = i;
+			i--;
+			//the byte after the scalar still has to be looked at as structure
+		} else if(s->state == scan_KEY)
+		{
+			frame* top = s->stack + s->depth - 1;
+			for(; i < len; i++)
+			{
+				c = bytes[i];
+				if(!s->escaped && (c == '"'))break;
+				if(!s->escaped && (c == '\\'))
+				{
+					s->escaped = 1;
+					continue;
+				}
+				if(s->escaped && (c != '"') && (c != '\\') && (c != '/'))
+				{
+					if(top->keyLen < jsonq_KEYMAX)top->key[top->keyLen++] = '\\';
+					else top->keyTooLong = 1;
+				}
+				//only the escapes that stand for themselves are undone
+				s->escaped = 0;
+
+				if(top->keyLen < jsonq_KEYMAX)top->key[top->keyLen++] = c;
+				else top->keyTooLong = 1;
+			}
+			if(i == len)break;
+
+			s->state = scan_VALUE;
+			continue;
+		} else
+		{
+			if((c == ' ') || (c == '\n') || (c == '\r') || (c == '\t'))continue;
+
+			frame* top = (s->depth > 0) ? (s->stack + s->depth - 1) : NULL;
+			if((c == ',') && (top != NULL))
+			{
+				if(top->kind == '[')top->index++;
+				else top->expectKey = 1;
+				continue;
+			}
+			if((c == ':') && (top != NULL))
+			{
+				top->expectKey = 0;
+				continue;
+			}
+			if((c == '}') || (c == ']'))
+			{
+				if((top == NULL) || ((c == '}') != (top->kind == '{')))
+				{
+					fprintf(stderr, "jsonq: unbalanced '%c' at byte %lld\n", c, s->offset + i);
+					s->failed = 1;
+					break;
+				}
+				s->depth--;
+				valueEnd(s, bytes, end);
+				continue;
+			}
+			//a container that was looked inside ends when its frame does
+			if((c == '"') && (top != NULL) && (top->kind == '{') && top->expectKey)
+			{
+				top->keyLen = 0;
+				top->keyTooLong = 0;
+				s->escaped = 0;
+				s->state = scan_KEY;
+				continue;
+			}
+
+			if(s->emitting)emitUpTo(s, bytes, i);
+			else s->emitFrom = i;
+			s->state = valueStart(s, c);
+			continue;
+			//the rest of the value is looked at by the other states
+		}
+
+		valueEnd(s, bytes, end);
+		s->state = scan_VALUE;
+		//the value ended
+	}
+
+	if(!s->failed)emitUpTo(s, bytes, len);
+	s->offset += len;
+	//the value goes on into the next block
+}//scans a block
+
+void scanFinish(scanner* s)
+{
+	if(s->failed)return;
+
+	if((s->state == scan_SCALAR) && (s->depth == 0) && scalarValid(s))
+	{
+		valueEnd(s, NULL, 0);
+		s->state = scan_VALUE;
+	}
+	//a scalar at the very end of the input has nothing after it to end it
+
+	if((s->state != scan_VALUE) || (s->depth > 0))
+	{
+		fprintf(stderr, "jsonq: the input ends in the middle of a value\n");
+		s->failed = 1;
+	}
+}//checks the end of the input
+
+char isDelimiter(char c)
+{
+	return (c == ',') || (c == ']') || (c == '}') || (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}//checks if a char ends a scalar
+
+char scalarValid(scanner* s)
+{
+	const char* literals[3] = {"true", "false", "null"};
+	for(int i = 0; i < 3; i++)
+		if((s->scalarLen == (long long) strlen(literals[i])) && (memcmp(s->scalar, literals[i], s->scalarLen) == 0))return 1;
+
+	if((s->scalar[0] != '-') && ((s->scalar[0] < '0') || (s->scalar[0] > '9')))return 0;
+	if((s->scalarLast < '0') || (s->scalarLast > '9'))return 0;
+
+	long long kept = (s->scalarLen < jsonq_SCALARMAX) ? s->scalarLen : jsonq_SCALARMAX;
+	for(long long i = 0; i < kept; i++)
+		if(strchr("0123456789+-.eE", s->scalar[i]) == NULL)return 0;
+	//only the start of a long number is looked at
+
+	return 1;
+}//checks a scalar
+
+int valueStart(scanner* s, char c)
+{
+	char container = (c == '{') || (c == '[');
+	int match = pathMatch(s);
+
+	if((match & match_EXACT) == match_EXACT)matchOpen(s);
+
+	s->inString = 0;
+	s->escaped = 0;
+
+	if(container && (s->depth == json_MAXDEPTH))
+	{
+		fprintf(stderr, "jsonq: nested deeper than %d\n", json_MAXDEPTH);
+		s->failed = 1;
+		return scan_VALUE;
+	}
+
+	if(container && ((match & match_INSIDE) != match_INSIDE))
+	{
+		s->nestKinds[0] = c == '{';
+		s->nest = 1;
+		return scan_SKIP;
+	}
+	//containers that can't hold a match are only walked to their end, even if they are printed
+
+	if(container)
+	{
+		frame* top = s->stack + s->depth;
+		s->depth++;
+		top->kind = c;
+		top->expectKey = c == '{';
+		top->index = 0;
+		top->keyLen = 0;
+		top->keyTooLong = 0;
+		return scan_VALUE;
+	}
+
+	if(c == '"')return scan_STRING;
+
+	s->scalar[0] = c;
+	s->scalarLen = 1;
+	s->scalarLast = c;
+	return scan_SCALAR;
+}//starts a value
+
+int pathMatch(scanner* s)
+{
+	int retVal = 0;
+	for(int i = 0; i < s->queryCount; i++)
+	{
+		query* q = s->queries + i;
+		if(q->segCount < s->depth)continue;
+
+		char matches = 1;
+		for(int j = 0; (j < s->depth) && matches; j++)
+		{
+			segment* seg = q->segs + j;
+			frame* f = s->stack + j;
+			if(seg->any)continue;
+
+			if(f->kind == '[')matches = seg->index == f->index;
+			else matches = !f->keyTooLong && (seg->keyLen == f->keyLen) && (memcmp(seg->key, f->key, f->keyLen) == 0);
+		}
+		if(!matches)continue;
+
+		retVal |= (q->segCount == s->depth) ? match_EXACT : match_INSIDE;
+	}
+
+	return retVal;
+}//matches the current path
+
+void matchOpen(scanner* s)
+{
+	s->matches++;
+	openMatch* m = s->open + s->openCount;
+	s->openCount++;
+	m->depth = s->depth;
+
+	if(!s->emitting)
+	{
+		s->emitting = 1;
+		m->held = -1;
+		if(s->printPaths)
+		{
+			pathText(s, &(s->paths));
+			fwrite(s->paths.bytes, 1, s->paths.len, s->out);
+			s->paths.len = 0;
+		}
+		return;
+	}
+	//the outer match is printed as it is scanned
+
+	if(s->heldCount == s->heldCapacity)
+	{
+		long long capacity = (s->heldCapacity == 0) ? 16 : s->heldCapacity * 2;
+		heldMatch* holder = (heldMatch*) realloc(s->held, sizeof(heldMatch) * capacity);
+		if(holder == NULL)
+		{
+			fprintf(stderr, "jsonq: out of memory\n");
+			s->failed = 1;
+			return;
+		}
+		s->held = holder;
+		s->heldCapacity = capacity;
+	}
+
+	heldMatch* h = s->held + s->heldCount;
+	m->held = s->heldCount++;
+	s->heldOpen++;
+	h->pathStart = s->paths.len;
+	if(s->printPaths)pathText(s, &(s->paths));
+	h->pathEnd = s->paths.len;
+	h->start = s->values.len;
+	h->end = -1;
+	//matches inside it are copied out of its text once it is printed
+}//starts a match
+
+void matchClose(scanner* s)
+{
+	openMatch* m = s->open + --(s->openCount);
+	if(m->held >= 0)
+	{
+		s->held[m->held].end = s->values.len;
+		s->heldOpen--;
+		return;
+	}
+
+	fputc('\n', s->out);
+	s->emitting = 0;
+
+	for(long long i = 0; i < s->heldCount; i++)
+	{
+		heldMatch* h = s->held + i;
+		if(s->printPaths)fwrite(s->paths.bytes + h->pathStart, 1, h->pathEnd - h->pathStart, s->out);
+		fwrite(s->values.bytes + h->start, 1, h->end - h->start, s->out);
+		fputc('\n', s->out);
+	}
+	s->heldCount = 0;
+	s->values.len = 0;
+	s->paths.len = 0;
+	//held matches come after the match they are in, in the order they started
+}//ends a match
+
+void emitUpTo(scanner* s, const char* bytes, long long to)
+{
+	if(!s->emitting || (to <= s->emitFrom))return;
+
+	fwrite(bytes + s->emitFrom, 1, to - s->emitFrom, s->out);
+	if((s->heldOpen > 0) && !textPut(&(s->values), bytes + s->emitFrom, to - s->emitFrom))
+	{
+		fprintf(stderr, "jsonq: out of memory\n");
+		s->failed = 1;
+	}
+	s->emitFrom = to;
+}//writes out the match being printed
+
+void valueEnd(scanner* s, const char* bytes, long long end)
+{
+	if((s->openCount == 0) || (s->open[s->openCount - 1].depth != s->depth))return;
+
+	emitUpTo(s, bytes, end);
+	matchClose(s);
+}//ends a match at the end of its value
+
+char textPut(text* t, const char* bytes, long long len)
+{
+	if(t->len + len > t->capacity)
+	{
+		long long capacity = (t->capacity == 0) ? 256 : t->capacity;
+		while(capacity < t->len + len)capacity *= 2;
+		char* holder = (char*) realloc(t->bytes, capacity);
+		if(holder == NULL)return 0;
+		t->bytes = holder;
+		t->capacity = capacity;
+	}
+	memcpy(t->bytes + t->len, bytes, len);
+	t->len += len;
+	return 1;
+}//adds bytes to a text
+
+void pathText(scanner* s, text* into)
+{
+	char index[24];
+	for(int i = 0; i < s->depth; i++)
+	{
+		frame* f = s->stack + i;
+		textPut(into, "/", 1);
+		if(f->kind == '[')
+		{
+			textPut(into, index, snprintf(index, sizeof(index), "%lld", f->index));
+			continue;
+		}
+		for(size_t j = 0; j < f->keyLen; j++)
+		{
+			if(f->key[j] == '~')textPut(into, "~0", 2);
+			else if(f->key[j] == '/')textPut(into, "~1", 2);
+			else textPut(into, f->key + j, 1);
+		}
+	}
+	textPut(into, "\t", 1);
+}//makes the current path
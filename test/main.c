@@ -1,6 +1,31 @@
 #include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "../jsonParser.h"
 
+long long hexSink(void* context, const char* bytes, long long len)
+{
+	for(long long i = 0; i < len; i++)printf("%02x", (unsigned char) bytes[i]);
+	return len;
+}//prints what json_transcode writes as hex
+
+json_slot* stressSlot;
+_Atomic int stressDone;
+
+void* stressReader(void* failed)
+{
+	int last = 0;
+	while(!stressDone)
+	{
+		json* version = json_slotAcquire(stressSlot);
+		int value = json_getInt(version);
+		if(value < last)*((int*) failed) = 1;
+		last = value;
+		json_release(&version);
+	}
+	return NULL;
+}//acquires versions of stressSlot until stressDone is set, checking that they only go forwards
+
 int main(void)
 {
 	json* test = json_parseFromPath("./test.json");
@@ -25,12 +50,593 @@ int main(void)
 
 	json *testArr = json_getMember(test, "test6");
 
+	long long packedLen = 0;
+	int64_t* packedInts = json_getInt64Array(testArr, &packedLen);
+
 	printf("test 6 -> %d, %d, %d, %d\n", 
 		json_getInt(json_getIndex(testArr, 0)),
 		json_getInt(json_getIndex(testArr, 1)),
 		json_getInt(json_getIndex(testArr, 2)),
 		json_getInt(json_getIndex(testArr, 3))
 	);
+
+	printf("test 14 -> %lld, %d, %d\n", 
+		packedLen,
+		(int) packedInts[0],
+		(int) packedInts[3]
+	);
+
+	json_saveSnapshot(test, "./test.snap");
+	json* snap = json_loadSnapshot("./test.snap");
+
+	printf("test 7 -> %s, %d, %d\n", 
+		json_getString(json_getMember(snap, "test1")),
+		json_getInt(json_getMember(snap, "test2")),
+		json_getInt(json_getIndex(json_getMember(snap, "test6"), 3))
+	);
+
+	json_remove(&snap);
+	remove("./test.snap");
+	json* cached1 = json_parseFromPathCached("./test.json");
+	json* cached2 = json_parseFromPathCached("./test.json");
+
+	printf("test 8 -> %d, %d\n", 
+		cached1 == cached2,
+		json_getInt(json_getMember(cached2, "test2"))
+	);
+
+	json_remove(&cached1);
+	json_remove(&cached2);
+	json_clearCache();
+
+	json_slot* slot = json_slotMake(json_freeze(json_parseFromPath("./test.json")));
+	json* version1 = json_slotAcquire(slot);
+	json_slotSwap(slot, json_freeze(json_parseFromPath("./test.json")));
+	json* version2 = json_slotAcquire(slot);
+
+	printf("test 9 -> %d, %d, %d\n", 
+		version1 != version2,
+		json_getInt(json_getMember(version1, "test2")),
+		json_getInt(json_getMember(version2, "test2"))
+	);
+
+	json_release(&version1);
+	json_release(&version2);
+	json_slotRemove(&slot);
+
+	json_setMember(test, "test2", json_newInt(401));
+	json_setMember(test, "test7", json_newString("added"));
+	json_removeMember(test, "test1");
+	json_push(testArr, json_newInt(100));
+	json_insertAt(testArr, 0, json_newInt(5));
+	json_removeAt(testArr, 1);
+
+	printf("test 10 -> %d, %s, %d, %d, %d, %d\n", 
+		json_getInt(json_getMember(test, "test2")),
+		json_getString(json_getMember(test, "test7")),
+		json_getMember(test, "test1") == NULL,
+		json_arrayLen(testArr),
+		json_getInt(json_getIndex(testArr, 0)),
+		json_getInt(json_getIndex(testArr, 4))
+	);
+
+	char editText[] = "{\"a\": [1, [2, 3]], \"b\": {\"c\": 4}}";
+	json* edited = json_parseEditable(editText, sizeof(editText) - 1);
+	json_reparse(edited, 11, 1, "20", 2);
+	json_reparse(edited, 31, 1, "40", 2);
+
+	printf("test 11 -> %d, %d\n", 
+		json_getInt(json_getIndex(json_getIndex(json_getMember(edited, "a"), 1), 0)),
+		json_getInt(json_getMember(json_getMember(edited, "b"), "c"))
+	);
+
+	json_remove(&edited);
+
+	char projectText[] = "{\"a\": {\"b\": 1, \"c\": [2, 3]}, \"d\": \"skipped\"}";
+	char* projectPaths[] = {"a.b"};
+	json* projected = json_parseProjected(projectText, sizeof(projectText) - 1, projectPaths, 1);
+
+	printf("test 12 -> %d, %d, %d\n", 
+		json_getInt(json_getMember(json_getMember(projected, "a"), "b")),
+		json_getMember(json_getMember(projected, "a"), "c") == NULL,
+		json_getMember(projected, "d") == NULL
+	);
+
+	json_remove(&projected);
+
+	char columnText[] = "[{\"id\": 1, \"name\": \"a\"}, {\"id\": 2.5}, {\"name\": \"bc\"}]";
+	char* columnFields[] = {"id", "name"};
+	json_columns columns;
+	json_toColumns(columnText, sizeof(columnText) - 1, columnFields, 2, &columns);
+
+	printf("test 15 -> %lld, %lf, %lf, %d, %.*s\n", 
+		columns.rows,
+		columns.columns[0].doubles[0],
+		columns.columns[0].doubles[1],
+		json_columnValid(&(columns.columns[0]), 2),
+		(int) (columns.columns[1].offsets[3] - columns.columns[1].offsets[2]),
+		columns.columns[1].heap + columns.columns[1].offsets[2]
+	);
+
+	json_columnsRemove(&columns);
+
+	char* batchPaths[] = {"./test.json", "./test.json"};
+	json* batch[2];
+	int batchParsed = json_parseFiles(batchPaths, 2, 2, batch);
+
+	printf("test 16 -> %d, %d, %d\n", 
+		batchParsed,
+		json_getInt(json_getMember(batch[0], "test2")),
+		json_getInt(json_getMember(batch[1], "test2"))
+	);
+
+	json_remove(&batch[0]);
+	json_remove(&batch[1]);
+
+	json_error validateError;
+	char validText[] = "{\"a\": [1, 2.5e3, \"\\u0041\", true, null]}";
+	char invalidText[] = "{\"a\": [1, 2.]}";
+	char validResult = json_validate(validText, sizeof(validText) - 1, NULL);
+	char invalidResult = json_validate(invalidText, sizeof(invalidText) - 1, &validateError);
+
+	printf("test 13 -> %d, %d, %d, %lld\n", 
+		validResult,
+		invalidResult,
+		validateError.code == json_ERR_NUMBER,
+		validateError.offset
+	);
+
+	printf("test 17 -> %zu, %d\n", 
+		json_arrayLen64(testArr),
+		json_getIndex64(testArr, 1) == json_getIndex(testArr, 1)
+	);
+
+	json_iter iter = json_iterMake(test);
+	size_t keyBytes = 0;
+	while(json_iterNext(&iter))keyBytes += iter.keyLen;
+
+	size_t firstKeyLen = 0;
+	json_objectKeyAt(test, 0, &firstKeyLen);
+
+	printf("test 18 -> %zu, %zu, %zu, %d\n", 
+		iter.length,
+		keyBytes,
+		firstKeyLen,
+		json_getInt(json_objectValueAt(test, 1))
+	);
+
+	char shapeText[] = "[{\"a\": 1, \"b\": 2}, {\"a\": 3, \"b\": 4}, {\"b\": 5}]";
+	json* shaped = json_parseEditable(shapeText, sizeof(shapeText) - 1);
+	json_keyHandle handleB = json_keyHandleMake("b");
+	int parsedShape = json_getIndex(shaped, 0)->shape;
+	int cachedB[3];
+	for(int i = 0; i < 3; i++)cachedB[i] = json_getInt(json_getMemberCached(json_getIndex(shaped, i), &handleB));
+
+	printf("test 19 -> %d, %d, %d, %d, %d, %d\n", 
+		cachedB[0],
+		cachedB[1],
+		cachedB[2],
+		json_getIndex(shaped, 0)->shape == json_getIndex(shaped, 1)->shape,
+		json_getIndex(shaped, 1)->shape != json_getIndex(shaped, 2)->shape,
+		parsedShape
+	);
+
+	json_remove(&shaped);
+
+	json* discarded = json_parseFromPath("./test.json");
+	json_removeAsync(&discarded);
+	json_waitForRemoves();
+
+	printf("test 20 -> %d\n", discarded == NULL);
+
+	json_writer* writer = json_writerMakeBuffer();
+	json_writerBeginObject(writer);
+	json_writerKey(writer, "a");
+	json_writerBeginArray(writer);
+	json_writerInt64(writer, -1234567890123LL);
+	json_writerDouble(writer, 2.5);
+	json_writerDouble(writer, 3);
+	json_writerString(writer, "q\"\n");
+	json_writerBool(writer, 1);
+	json_writerNull(writer);
+	json_writerEndArray(writer);
+	json_writerKey(writer, "b");
+	json_writerValue(writer, json_getMember(test, "test6"));
+	char writerOk = json_writerEndObject(writer);
+	char misuseOk = json_writerEndArray(writer);
+
+	printf("test 21 -> %s, %d, %d\n", 
+		json_writerBuffer(writer, NULL),
+		writerOk,
+		misuseOk
+	);
+
+	json_writerRemove(&writer);
+
+	char lazyText[] = "{\"big\":1.50e2,\"neg\":-42,\"list\":[1,-2]}";
+	json* lazy = json_parseLazy(lazyText, sizeof(lazyText) - 1);
+	size_t numberLen = 0;
+	const char* numberText = json_getNumberText(json_getMember(lazy, "big"), &numberLen);
+
+	json_writer* lazyWriter = json_writerMakeBuffer();
+	json_writerValue(lazyWriter, lazy);
+
+	printf("test 22 -> %.*s, %g, %d, %d, %s\n", 
+		(int) numberLen, numberText,
+		json_getDouble(json_getMember(lazy, "big")),
+		json_getInt(json_getMember(lazy, "neg")),
+		json_getInt(json_getIndex(json_getMember(lazy, "list"), 1)),
+		json_writerBuffer(lazyWriter, NULL)
+	);
+
+	json_writerRemove(&lazyWriter);
+	lazy = json_freeze(lazy);
+	json_release(&lazy);
+
+	int pipeFds[2];
+	json* piped = NULL;
+	if(pipe(pipeFds) == 0)
+	{
+		ssize_t pipeWrote = write(pipeFds[1], "[1, [2, 3], -4]", 15);
+		close(pipeFds[1]);
+		FILE* pipePtr = fdopen(pipeFds[0], "rb");
+		if(pipeWrote == 15 && pipePtr != NULL)piped = json_parse(pipePtr);
+		if(pipePtr != NULL)fclose(pipePtr);
+		else close(pipeFds[0]);
+	}
+	//a failed pipe or write leaves piped NULL, which fails the test rather than hanging it
+
+	FILE* headed = tmpfile();
+	json* afterHeader = NULL;
+	if(headed != NULL)
+	{
+		char header[4];
+		fputs("HDR\n[5, 6, 7]", headed);
+		rewind(headed);
+		if(fread(header, 1, 4, headed) == 4)afterHeader = json_parse(headed);
+		fclose(headed);
+	}
+
+	printf("test 23 -> %d, %d, %d\n", 
+		json_arrayLen(piped),
+		json_getInt(json_getIndex(piped, 2)),
+		json_arrayLen(afterHeader)
+	);
+
+	json_remove(&piped);
+	json_remove(&afterHeader);
+
+	char limitText[] = "[[[true, false]], [null]]";
+	json_limits limits = {0};
+	limits.maxDepth = 2;
+	json_error limitErr;
+	json* limited = json_parseLimited(limitText, sizeof(limitText) - 1, &limits, &limitErr);
+	char depthCaught = (limited == NULL) && (limitErr.code == json_ERR_DEPTH);
+
+	limits.maxDepth = 3;
+	limited = json_parseLimited(limitText, sizeof(limitText) - 1, &limits, &limitErr);
+
+	printf("test 24 -> %d, %d, %d\n", 
+		depthCaught,
+		limitErr.code,
+		json_getBool(json_getIndex(json_getIndex(json_getIndex(limited, 0), 0), 0))
+	);
+
+	json_remove(&limited);
+
+	char inlineText[] = "{\"\": \"123456789012345\", \"long\": \"1234567890123456\"}";
+	json* inlined = json_parseLimited(inlineText, sizeof(inlineText) - 1, NULL, NULL);
+
+	printf("test 25 -> %s, %s\n", 
+		json_getString(json_getMember(inlined, "")),
+		json_getString(json_getMember(inlined, "long"))
+	);
+
+	json_remove(&inlined);
+
+	json* compacted = json_parseFromPath("./test.json");
+	char compactOk = json_compact(&compacted);
+	json_keyHandle handleTest2 = json_keyHandleMake("test2");
+	json* rejected = json_newInt(1);
+
+	printf("test 26 -> %d, %s, %d, %d, %d\n", 
+		compactOk,
+		json_getString(json_getMember(compacted, "test1")),
+		json_getInt(json_getMemberCached(compacted, &handleTest2)),
+		json_getInt(json_getIndex(json_getMember(compacted, "test6"), 3)),
+		json_push(json_getMember(compacted, "test6"), rejected)
+	);
+
+	json_remove(&rejected);
+
+	compacted = json_freeze(compacted);
+	json_release(&compacted);
+	char dedupText[] = "[{\"cur\": {\"code\": \"USD\", \"digits\": 2}}, {\"cur\": {\"code\": \"USD\", \"digits\": 2}}, {\"cur\": {\"code\": \"EUR\", \"digits\": 2}}]";
+	json* deduped = json_parseLimited(dedupText, sizeof(dedupText) - 1, NULL, NULL);
+	char dedupOk = json_dedup(&deduped);
+
+	printf("test 27 -> %d, %d, %d, %s, %d\n", 
+		dedupOk,
+		json_getIndex(deduped, 0) == json_getIndex(deduped, 1),
+		json_getIndex(deduped, 1) == json_getIndex(deduped, 2),
+		json_getString(json_getMember(json_getMember(json_getIndex(deduped, 2), "cur"), "code")),
+		json_getMember(json_getMember(json_getIndex(deduped, 0), "cur"), "digits") == 
+			json_getMember(json_getMember(json_getIndex(deduped, 2), "cur"), "digits")
+	);
+
+	json_remove(&deduped);
+	char transcodeText[] = "{\"a\": [1, -2, 300, 1.5, \"\\u00e9\", true, null, -0]}";
+
+	printf("test 28 -> ");
+	char msgpackOk = json_transcode(transcodeText, sizeof(transcodeText) - 1, json_TO_MSGPACK, hexSink, NULL, NULL);
+	printf(", ");
+	char cborOk = json_transcode(transcodeText, sizeof(transcodeText) - 1, json_TO_CBOR, hexSink, NULL, NULL);
+	printf(", %d, %d, %d\n", msgpackOk, cborOk, json_transcode("[1, 2", 5, json_TO_CBOR, hexSink, NULL, NULL));
+
+	json* gzipped = json_parseFromPath("./test.json.gz");
+	char* gzippedPaths[] = {"./test.json.gz"};
+	json* gzippedBatch[1];
+	int gzippedParsed = json_parseFiles(gzippedPaths, 1, 1, gzippedBatch);
+
+#ifdef JSON_ZLIB
+	printf("test 29 -> %s, %d, %d, %d\n", 
+		json_getString(json_getMember(gzipped, "test1")),
+		json_getInt(json_getMember(gzipped, "test2")),
+		gzippedParsed,
+		json_getInt(json_getMember(gzippedBatch[0], "test2"))
+	);
+#else
+	printf("test 29 -> %d, %d\n", gzipped == NULL, gzippedParsed);
+#endif
+
+	json_remove(&gzipped);
+	json_remove(&gzippedBatch[0]);
+
+	stressSlot = json_slotMake(json_freeze(json_newInt(0)));
+	pthread_t readers[8];
+	int readerFailed[8] = {0};
+	for(int i = 0; i < 8; i++)pthread_create(readers + i, NULL, stressReader, readerFailed + i);
+	for(int i = 1; i <= 20000; i++)json_slotSwap(stressSlot, json_freeze(json_newInt(i)));
+	stressDone = 1;
+
+	int stressFailed = 0;
+	for(int i = 0; i < 8; i++)
+	{
+		pthread_join(readers[i], NULL);
+		stressFailed |= readerFailed[i];
+	}
+	json* stressLast = json_slotAcquire(stressSlot);
+
+	printf("test 30 -> %d, %d\n", stressFailed, json_getInt(stressLast));
+
+	json_release(&stressLast);
+	json_slotRemove(&stressSlot);
+
+	char bigText[] = "{\"big\": -5000000000}";
+	json* bigInts = json_parseLimited(bigText, sizeof(bigText) - 1, NULL, NULL);
+	char bigSet = json_setMember(bigInts, "bigger", json_newInt64(9000000000000000000LL));
+
+	printf("test 31 -> %lld, %lld, %d\n", 
+		json_getInt64(json_getMember(bigInts, "big")),
+		json_getInt64(json_getMember(bigInts, "bigger")),
+		bigSet
+	);
+
+	json_remove(&bigInts);
+
+	char packText[] = "[[3000000000, 1], [102, 0.5], [0.5, 9007199254740993]]";
+	json* packs = json_parseLimited(packText, sizeof(packText) - 1, NULL, NULL);
+	int64_t* bigPacked = json_getInt64Array(json_getIndex(packs, 0), NULL);
+	double* mixedPacked = json_getDoubleArray(json_getIndex(packs, 1), NULL);
+	double mixedFirst = mixedPacked[0];
+	double mixedSecond = mixedPacked[1];
+	json* heldView = json_getIndex(json_getIndex(packs, 1), 1);
+	char viewPushed = json_push(json_getIndex(packs, 1), json_newInt(7));
+	json_removeAt(json_getIndex(packs, 1), 0);
+
+	printf("test 32 -> %lld, %.1f, %.1f, %d, %.1f, %d, %d\n", 
+		(long long) bigPacked[0],
+		mixedFirst,
+		mixedSecond,
+		json_getDoubleArray(json_getIndex(packs, 2), NULL) == NULL,
+		json_getDouble(heldView),
+		viewPushed,
+		json_arrayLen(json_getIndex(packs, 1))
+	);
+
+	json_remove(&packs);
+
+	printf("test 33 -> %d, %d\n", 
+		json_removeAt(testArr, (size_t) -1),
+		json_removeAt(testArr, json_arrayLen64(testArr))
+	);
+
+	json* longString = json_newString("a string longer than the node");
+	json* shortString = json_newString("short");
+	size_t longLen = 0;
+	size_t shortLen = 0;
+	json_getStringLen(longString, &longLen);
+	json_getStringLen(shortString, &shortLen);
+
+	printf("test 34 -> %zu, %zu, %d\n", longLen, shortLen, json_getStringLen(json_getMember(test, "test2"), NULL) == NULL);
+
+	json_remove(&longString);
+	json_remove(&shortString);
+
+	json* deep = json_newArray();
+	json* deepest = deep;
+	long long deepLevels = 0;
+	for(; deepLevels < 1000000; deepLevels++)
+	{
+		json* next = json_newArray();
+		if(!json_push(deepest, next))break;
+		deepest = next;
+	}
+	json_remove(&deep);
+
+	printf("test 35 -> %lld, %d\n", deepLevels, deep == NULL);
+
+	char budgetText[] = "{\"a\": [1, 2, 3], \"b\": \"hello\"}";
+	json_error budgetErr[4];
+	json_limits budgetLimits[4] = {{0}, {0}, {0}, {0}};
+	budgetLimits[0].maxBytes = 10;
+	budgetLimits[1].maxNodes = 3;
+	budgetLimits[2].maxStringLen = 4;
+	budgetLimits[3].maxMemory = 64;
+	char budgetCaught = 1;
+	for(int i = 0; i < 4; i++)
+		budgetCaught &= json_parseLimited(budgetText, sizeof(budgetText) - 1, budgetLimits + i, budgetErr + i) == NULL;
+
+	printf("test 36 -> %d, %d %lld, %d %lld, %d %lld, %d %lld\n", 
+		budgetCaught,
+		budgetErr[0].code == json_ERR_BYTES, budgetErr[0].offset,
+		budgetErr[1].code == json_ERR_NODES, budgetErr[1].offset,
+		budgetErr[2].code == json_ERR_STRINGLEN, budgetErr[2].offset,
+		budgetErr[3].code == json_ERR_MEMORY, budgetErr[3].offset
+	);
+
+	char boolText[] = "[true,false]";
+	char openText[] = "[\"abc";
+	json_error openErr;
+	json* bools = json_parseLimited(boolText, sizeof(boolText) - 1, NULL, NULL);
+	json* opened = json_parseLimited(openText, sizeof(openText) - 1, NULL, &openErr);
+
+	printf("test 37 -> %d, %d, %d, %d, %d %lld\n", 
+		json_arrayLen(bools),
+		json_getBool(json_getIndex(bools, 0)),
+		json_getBool(json_getIndex(bools, 1)),
+		opened == NULL,
+		openErr.code == json_ERR_END, openErr.offset
+	);
+
+	json_remove(&bools);
+
+	char nulText[] = "[\"a\\u0000bcdefghijklmnopqrstuvwxyz\"]";
+	json* nuls = json_parseLimited(nulText, sizeof(nulText) - 1, NULL, NULL);
+	char nulCompacted = json_compact(&nuls);
+	size_t nulLen = 0;
+	const char* nulString = json_getStringLen(json_getIndex(nuls, 0), &nulLen);
+
+	printf("test 38 -> %d, %zu, %s\n", 
+		nulCompacted,
+		nulLen,
+		nulString + 2
+	);
+
+	json_remove(&nuls);
+
+	json* unfrozen = json_newInt(1);
+	json_slot* strictSlot = json_slotMake(json_freeze(json_newInt(0)));
+	char unfrozenMade = json_slotMake(unfrozen) != NULL;
+	char unfrozenSwapped = json_slotSwap(strictSlot, unfrozen);
+	char frozenSwapped = json_slotSwap(strictSlot, json_freeze(json_newInt(2)));
+	json* strictVersion = json_slotAcquire(strictSlot);
+
+	printf("test 39 -> %d, %d, %d, %d\n", 
+		unfrozenMade,
+		unfrozenSwapped,
+		frozenSwapped,
+		json_getInt(strictVersion)
+	);
+
+	json_release(&strictVersion);
+	json_slotRemove(&strictSlot);
+	json_remove(&unfrozen);
+
+	char frozenText[] = "{\"o\": {\"k\": 1}, \"l\": [1, 2], \"m\": [{}, \"s\"]}";
+	json* frozenTree = json_freeze(json_parseLimited(frozenText, sizeof(frozenText) - 1, NULL, NULL));
+	json* cachedTree = json_parseFromPathCached("./test.json");
+	json* spare = json_newInt(3);
+
+	printf("test 40 -> %d, %d, %d, %d, %d, %d, %d\n", 
+		json_setMember(json_getMember(frozenTree, "o"), "k", spare),
+		json_removeMember(json_getMember(frozenTree, "o"), "k"),
+		json_push(json_getMember(frozenTree, "l"), spare),
+		json_insertAt(json_getMember(frozenTree, "m"), 0, spare),
+		json_removeAt(json_getMember(frozenTree, "m"), 0),
+		json_push(json_getMember(cachedTree, "test6"), spare),
+		json_getInt(json_getMember(json_getMember(frozenTree, "o"), "k"))
+	);
+
+	json_remove(&spare);
+	json_release(&cachedTree);
+	json_release(&frozenTree);
+	json_clearCache();
+
+	char duplicateText[] = "[{\"s\": \"ab\", \"n\": 1, \"s\": \"cd\", \"n\": null}, {\"s\": \"ef\"}]";
+	char* duplicateFields[] = {"s", "n"};
+	json_columns duplicates;
+	char duplicateRead = json_toColumns(duplicateText, sizeof(duplicateText) - 1, duplicateFields, 2, &duplicates);
+
+	printf("test 41 -> %d, %.*s, %.*s, %d\n", 
+		duplicateRead,
+		(int) (duplicates.columns[0].offsets[1] - duplicates.columns[0].offsets[0]), duplicates.columns[0].heap + duplicates.columns[0].offsets[0],
+		(int) (duplicates.columns[0].offsets[2] - duplicates.columns[0].offsets[1]), duplicates.columns[0].heap + duplicates.columns[0].offsets[1],
+		json_columnValid(duplicates.columns + 1, 0)
+	);
+
+	json_columnsRemove(&duplicates);
+
+	char nulKeyText[] = "{\"a\\u0000b\": 1, \"a\": 2}";
+	json* nulKeys = json_parseLimited(nulKeyText, sizeof(nulKeyText) - 1, NULL, NULL);
+
+	printf("test 42 -> %d, %d\n", 
+		json_getInt(json_getMemberLen(nulKeys, "a\0b", 3)),
+		json_getInt(json_getMember(nulKeys, "a"))
+	);
+
+	json_remove(&nulKeys);
+
+	char compactPackText[] = "{\"i\": [1, 2, 3], \"d\": [0.5, 2.5], \"j\": [1, 2, 3]}";
+	json* compactPacks = json_parseLimited(compactPackText, sizeof(compactPackText) - 1, NULL, NULL);
+	json* dedupPacks = json_parseLimited(compactPackText, sizeof(compactPackText) - 1, NULL, NULL);
+	json_getIndex(json_getMember(compactPacks, "i"), 0);
+	char packsCompacted = json_compact(&compactPacks) && json_dedup(&dedupPacks);
+	long long compactIntsLen = 0;
+	int64_t* compactInts = json_getInt64Array(json_getMember(compactPacks, "i"), &compactIntsLen);
+	double* compactDoubles = json_getDoubleArray(json_getMember(compactPacks, "d"), NULL);
+
+	printf("test 43 -> %d, %lld, %lld, %.1f, %d, %d\n", 
+		packsCompacted,
+		compactIntsLen,
+		(long long) compactInts[2],
+		compactDoubles[1],
+		json_getInt(json_getIndex(json_getMember(compactPacks, "i"), 1)),
+		json_getMember(dedupPacks, "i") == json_getMember(dedupPacks, "j")
+	);
+
+	json_getIndex(json_getMember(dedupPacks, "j"), 0);
+	json_remove(&compactPacks);
+	json_remove(&dedupPacks);
+
+	char dedupNulText[] = "[\"a\\u0000b\", \"a\\u0000c\", \"a\\u0000b\"]";
+	json* dedupNuls = json_parseLimited(dedupNulText, sizeof(dedupNulText) - 1, NULL, NULL);
+	char nulsDeduped = json_dedup(&dedupNuls);
+	size_t dedupNulLen = 0;
+	const char* dedupNulSecond = json_getStringLen(json_getIndex(dedupNuls, 1), &dedupNulLen);
+
+	printf("test 44 -> %d, %d, %d, %d, %c\n", 
+		nulsDeduped,
+		json_getIndex(dedupNuls, 0) == json_getIndex(dedupNuls, 2),
+		json_getIndex(dedupNuls, 0) != json_getIndex(dedupNuls, 1),
+		(int) dedupNulLen,
+		dedupNulSecond[2]
+	);
+
+	json_remove(&dedupNuls);
+
+	json_writer* zeroWriter = json_writerMakeBuffer();
+	json_writerBeginArray(zeroWriter);
+	json_writerDouble(zeroWriter, -0.0);
+	json_writerDouble(zeroWriter, 0.0);
+	json_writerDouble(zeroWriter, -0.25);
+	json_writerEndArray(zeroWriter);
+
+	printf("test 45 -> %s\n", json_writerBuffer(zeroWriter, NULL));
+
+	json_writerRemove(&zeroWriter);
+
+	json_remove(&test);
 	
 	return 0;
 }
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+#include "../jsonParser.hpp"
+
+int main()
+{
+	jsonParser::Document test = jsonParser::Document::fromPath("./test.json");
+
+	std::string_view greeting = test["test1"].get<std::string_view>();
+	std::printf("test cpp 1 -> %.*s\n", (int) greeting.size(), greeting.data());
+
+	std::printf("test cpp 2 -> %d, %lf, %d\n", 
+		test["test2"].get<int>(),
+		test["test3"].get<double>(),
+		test["test4"].get<bool>()
+	);
+
+	int sum = 0;
+	for(jsonParser::Value element : test["test6"])sum += element.get<int>();
+
+	std::printf("test cpp 3 -> %d, %zu\n", 
+		sum,
+		test["test6"].size()
+	);
+
+	std::size_t memberCount = 0;
+	std::size_t keyBytes = 0;
+	for(auto [key, value] : test.value().members())
+	{
+		memberCount++;
+		keyBytes += key.size();
+	}
+
+	jsonParser::Value numbers = test["test6"];
+	auto found = std::lower_bound(numbers.begin(), numbers.end(), 35, 
+		[](jsonParser::Value element, int target) { return element.get<int>() < target; }
+	);
+
+	std::printf("test cpp 5 -> %d, %d, %td, %d\n", 
+		(*std::prev(numbers.end())).get<int>(),
+		numbers.begin()[1].get<int>(),
+		found - numbers.begin(),
+		numbers.begin() < numbers.end()
+	);
+
+	jsonParser::Document moved = std::move(test);
+
+	std::printf("test cpp 4 -> %zu, %zu, %d, %d\n", 
+		memberCount,
+		keyBytes,
+		(bool) test,
+		(bool) moved["missing"]
+	);
+
+	return 0;
+}